@@ -0,0 +1,58 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <new>
+
+inline constexpr size_t kCacheLineSize = 64;
+inline constexpr size_t kPageSize = 4096;
+
+// Выделяет память с выравниванием не меньше Alignment (и не меньше alignof(T)) через
+// выравнивающие перегрузки operator new. Нужен для буферов SIMD-ядер и для O_DIRECT,
+// где требуется выравнивание сильнее, чем у самого типа элемента.
+// Типы с alignof(T) больше __STDCPP_DEFAULT_NEW_ALIGNMENT__ правильно выравнивает
+// и std::allocator, используемый Vector по умолчанию
+template <typename T, size_t Alignment = alignof(T)>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    static constexpr size_t kAlignment = Alignment > alignof(T) ? Alignment : alignof(T);
+    static_assert((kAlignment & (kAlignment - 1)) == 0, "Alignment must be a power of two");
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(kAlignment)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        operator delete(ptr, n * sizeof(T), std::align_val_t(kAlignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, size_t Alignment, typename GrowthPolicy = DoublingGrowth>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, GrowthPolicy>;
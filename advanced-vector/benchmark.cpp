@@ -0,0 +1,513 @@
+#include "buffer_pool.h"
+#include "circular_vector.h"
+#include "flat_map.h"
+#include "test_objects.h"
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Счётчики общие для всех копий CountingAllocator и сбрасываются перед каждым бенчмарком
+struct AllocationCounters {
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+};
+
+inline AllocationCounters allocation_counters;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        ++allocation_counters.allocations;
+        allocation_counters.bytes_allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+struct Pod256 {
+    char bytes[256];
+};
+
+template <typename T>
+using StdVector = std::vector<T, CountingAllocator<T>>;
+
+template <typename T>
+using AdvancedVector = Vector<T, CountingAllocator<T>>;
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        // Строка длиннее буфера SSO, чтобы копирование стоило выделения памяти
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+    else if constexpr (std::is_same_v<T, Obj>) {
+        return Obj(static_cast<int>(i));
+    }
+    else if constexpr (std::is_same_v<T, Pod256>) {
+        Pod256 pod{};
+        pod.bytes[0] = static_cast<char>(i);
+        return pod;
+    }
+    else {
+        return static_cast<T>(i);
+    }
+}
+
+// Единый интерфейс к std::vector и Vector, чтобы одни и те же бенчмарки работали с обоими
+template <typename Container>
+struct Ops;
+
+template <typename T>
+struct Ops<StdVector<T>> {
+    template <typename... Args>
+    static void EmplaceBack(StdVector<T>& v, Args&&... args) {
+        v.emplace_back(std::forward<Args>(args)...);
+    }
+
+    static void PushBack(StdVector<T>& v, const T& value) {
+        v.push_back(value);
+    }
+
+    static void Reserve(StdVector<T>& v, size_t n) {
+        v.reserve(n);
+    }
+
+    static void Resize(StdVector<T>& v, size_t n) {
+        v.resize(n);
+    }
+
+    static void InsertAt(StdVector<T>& v, size_t pos, const T& value) {
+        v.insert(v.begin() + pos, value);
+    }
+
+    static void EraseAt(StdVector<T>& v, size_t pos) {
+        v.erase(v.begin() + pos);
+    }
+
+    static T* Data(StdVector<T>& v) {
+        return v.data();
+    }
+
+    static void UncheckedPushBack(StdVector<T>& v, const T& value) {
+        v.push_back(value);
+    }
+
+    static T* GrowBy(StdVector<T>& v, size_t n) {
+        const size_t old_size = v.size();
+        v.resize(old_size + n);
+        return v.data() + old_size;
+    }
+};
+
+template <typename T>
+struct Ops<AdvancedVector<T>> {
+    template <typename... Args>
+    static void EmplaceBack(AdvancedVector<T>& v, Args&&... args) {
+        v.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    static void PushBack(AdvancedVector<T>& v, const T& value) {
+        v.PushBack(value);
+    }
+
+    static void Reserve(AdvancedVector<T>& v, size_t n) {
+        v.Reserve(n);
+    }
+
+    static void Resize(AdvancedVector<T>& v, size_t n) {
+        v.Resize(n);
+    }
+
+    static void InsertAt(AdvancedVector<T>& v, size_t pos, const T& value) {
+        v.Insert(v.begin() + pos, value);
+    }
+
+    static void EraseAt(AdvancedVector<T>& v, size_t pos) {
+        v.Erase(v.begin() + pos);
+    }
+
+    static T* Data(AdvancedVector<T>& v) {
+        return v.begin();
+    }
+
+    static void UncheckedPushBack(AdvancedVector<T>& v, const T& value) {
+        v.UncheckedEmplaceBack(value);
+    }
+
+    static T* GrowBy(AdvancedVector<T>& v, size_t n) {
+        return v.GrowBy(n);
+    }
+};
+
+template <typename Container>
+Container MakeFilled(size_t size) {
+    Container v;
+    Ops<Container>::Reserve(v, size);
+    for (size_t i = 0; i < size; ++i) {
+        Ops<Container>::EmplaceBack(v, MakeValue<typename Container::value_type>(i));
+    }
+    return v;
+}
+
+void StartCounting() {
+    allocation_counters = AllocationCounters{};
+    Obj::ResetCounters();
+}
+
+// ops_per_iteration операций за итерацию; containers_per_iteration — сколько за итерацию
+// создаётся буферов с нуля, остальные выделения считаются перевыделениями при росте
+void ReportCounters(benchmark::State& state, size_t ops_per_iteration, size_t containers_per_iteration) {
+    const auto iterations = static_cast<double>(state.iterations());
+    const auto allocations = static_cast<double>(allocation_counters.allocations);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ops_per_iteration));
+    // Секунды на операцию; печатается с SI-приставкой, например 1.7n
+    state.counters["time_per_op"] = benchmark::Counter(iterations * static_cast<double>(ops_per_iteration),
+                                                       benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["allocs"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    state.counters["bytes"] = benchmark::Counter(static_cast<double>(allocation_counters.bytes_allocated),
+                                                 benchmark::Counter::kAvgIterations);
+    const double reallocations = allocations - iterations * static_cast<double>(containers_per_iteration);
+    state.counters["reallocs"] = benchmark::Counter(reallocations > 0 ? reallocations : 0,
+                                                    benchmark::Counter::kAvgIterations);
+}
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const auto size = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    StartCounting();
+    for (auto _ : state) {
+        Container v;
+        for (size_t i = 0; i < size; ++i) {
+            Ops<Container>::PushBack(v, value);
+        }
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, size, 1);
+}
+
+template <typename Container>
+void BM_EmplaceBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const auto size = static_cast<size_t>(state.range(0));
+    StartCounting();
+    for (auto _ : state) {
+        Container v;
+        for (size_t i = 0; i < size; ++i) {
+            Ops<Container>::EmplaceBack(v, MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, size, 1);
+}
+
+template <typename Container>
+void BM_ReserveFill(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const auto size = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    StartCounting();
+    for (auto _ : state) {
+        Container v;
+        Ops<Container>::Reserve(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            Ops<Container>::PushBack(v, value);
+        }
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, size, 1);
+}
+
+// Заполнение после Reserve без проверки вместимости; у std::vector — обычный push_back
+template <typename Container>
+void BM_UncheckedFill(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const auto size = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    StartCounting();
+    for (auto _ : state) {
+        Container v;
+        Ops<Container>::Reserve(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            Ops<Container>::UncheckedPushBack(v, value);
+        }
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, size, 1);
+}
+
+// Цикл декодера: место под пакет из 16 значений выделяется разом и заполняется напрямую.
+// std::vector при этом обнуляет элементы в resize
+template <typename Container>
+void BM_GrowByPacket(benchmark::State& state) {
+    using T = typename Container::value_type;
+    constexpr size_t kPacket = 16;
+    const auto size = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    StartCounting();
+    for (auto _ : state) {
+        Container v;
+        for (size_t i = 0; i < size; i += kPacket) {
+            T* slots = Ops<Container>::GrowBy(v, kPacket);
+            for (size_t j = 0; j < kPacket; ++j) {
+                slots[j] = value;
+            }
+        }
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, size, 1);
+}
+
+// Вставка в середину и удаление оттуда же: размер вектора между итерациями не меняется
+template <typename Container>
+void BM_InsertEraseMiddle(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const auto size = static_cast<size_t>(state.range(0));
+    Container v = MakeFilled<Container>(size);
+    Ops<Container>::Reserve(v, size + 1);
+    const T value = MakeValue<T>(7);
+    StartCounting();
+    for (auto _ : state) {
+        Ops<Container>::InsertAt(v, size / 2, value);
+        Ops<Container>::EraseAt(v, size / 2);
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, 2, 0);
+}
+
+// Повторное присваивание в вектор, вместимости которого хватает: буфер должен переиспользоваться
+template <typename Container>
+void BM_CopyAssign(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    const Container source = MakeFilled<Container>(size);
+    Container target = MakeFilled<Container>(size);
+    StartCounting();
+    for (auto _ : state) {
+        target = source;
+        benchmark::DoNotOptimize(Ops<Container>::Data(target));
+    }
+    ReportCounters(state, size, 0);
+}
+
+template <typename Container>
+void BM_Resize(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    StartCounting();
+    for (auto _ : state) {
+        Container v;
+        Ops<Container>::Resize(v, size / 2);
+        Ops<Container>::Resize(v, size);
+        benchmark::DoNotOptimize(Ops<Container>::Data(v));
+    }
+    ReportCounters(state, size, 1);
+}
+
+// Короткоживущие векторы, как в обработчике запроса: с PooledAllocator
+// буферы после первой итерации берутся из кэша потока
+template <typename Allocator>
+void BM_ShortLivedVectors(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        Vector<int, Allocator> v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+// Поиск случайных ключей, половины из которых нет: std::set против FlatSet
+// с двоичным поиском и с индексом Эйтцингера
+template <typename Set, bool kIndexed = false>
+void BM_SetLookup(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    Set set;
+    if constexpr (std::is_same_v<Set, std::set<int>>) {
+        for (size_t i = 0; i < size; ++i) {
+            set.insert(static_cast<int>(2 * i));
+        }
+    }
+    else {
+        Vector<int> keys;
+        for (size_t i = 0; i < size; ++i) {
+            keys.PushBack(static_cast<int>(2 * i));
+        }
+        set.InsertSorted(keys);
+        if constexpr (kIndexed) {
+            set.BuildIndex();
+        }
+    }
+    uint32_t seed = 1;
+    for (auto _ : state) {
+        seed = seed * 1664525 + 1013904223;
+        const int key = static_cast<int>(seed % (2 * size));
+        if constexpr (std::is_same_v<Set, std::set<int>>) {
+            benchmark::DoNotOptimize(set.count(key));
+        }
+        else {
+            benchmark::DoNotOptimize(set.Contains(key));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Очередь постоянной длины: добавление в конец и извлечение из начала.
+// У Vector извлечение — Erase(begin()), сдвигающий весь хвост
+template <typename Queue>
+void BM_Fifo(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    Queue queue;
+    for (size_t i = 0; i < size; ++i) {
+        queue.PushBack(static_cast<int>(i));
+    }
+    int next = 0;
+    for (auto _ : state) {
+        queue.PushBack(next++);
+        if constexpr (std::is_same_v<Queue, Vector<int>>) {
+            queue.Erase(queue.begin());
+        }
+        else {
+            queue.PopFront();
+        }
+        benchmark::DoNotOptimize(queue[0]);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Узел размером в строку кэша; узлы перемешаны, поэтому соседние указатели ведут в далёкие строки
+struct alignas(64) Node {
+    uint64_t payload;
+};
+
+Vector<Node*> MakeShuffledNodes(Vector<Node>& pool) {
+    Vector<Node*> nodes;
+    nodes.Reserve(pool.Size());
+    for (size_t i = 0; i < pool.Size(); ++i) {
+        // Множитель взаимно прост с размером пула: перестановка без повторов
+        nodes.PushBack(&pool[i * 40503 % pool.Size()]);
+    }
+    return nodes;
+}
+
+// Сумма по вектору указателей: обычный цикл против ForEachPrefetched
+template <bool kPrefetch>
+void BM_PointerTraversal(benchmark::State& state) {
+    Vector<Node> pool(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < pool.Size(); ++i) {
+        pool[i].payload = i;
+    }
+    const Vector<Node*> nodes = MakeShuffledNodes(pool);
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        if constexpr (kPrefetch) {
+            nodes.ForEachPrefetched(16, [&sum](const Node* node) {
+                sum += node->payload;
+            });
+        }
+        else {
+            for (const Node* node : nodes) {
+                sum += node->payload;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * nodes.Size()));
+}
+
+// Выборка по случайным индексам: цикл с operator[] против Gather с упреждением
+template <bool kPrefetch>
+void BM_Gather(benchmark::State& state) {
+    Vector<uint64_t> table(static_cast<size_t>(state.range(0)));
+    Vector<uint32_t> indices;
+    for (size_t i = 0; i < 1 << 16; ++i) {
+        indices.PushBack(static_cast<uint32_t>(i * 2654435761u % table.Size()));
+    }
+    for (auto _ : state) {
+        if constexpr (kPrefetch) {
+            Vector<uint64_t> gathered = table.Gather(indices, 16);
+            benchmark::DoNotOptimize(gathered.begin());
+        }
+        else {
+            Vector<uint64_t> gathered;
+            gathered.Reserve(indices.Size());
+            for (uint32_t index : indices) {
+                gathered.UncheckedEmplaceBack(table[index]);
+            }
+            benchmark::DoNotOptimize(gathered.begin());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * indices.Size()));
+}
+
+void Sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(16)->Range(16, 1 << 16);
+}
+
+}  // namespace
+
+#define VECTOR_BENCHMARK_FOR_TYPE(bench, T)                                  \
+    BENCHMARK_TEMPLATE(bench, StdVector<T>)->Apply(Sizes);                  \
+    BENCHMARK_TEMPLATE(bench, AdvancedVector<T>)->Apply(Sizes)
+
+#define VECTOR_BENCHMARK(bench)                                              \
+    VECTOR_BENCHMARK_FOR_TYPE(bench, int);                                   \
+    VECTOR_BENCHMARK_FOR_TYPE(bench, std::string);                           \
+    VECTOR_BENCHMARK_FOR_TYPE(bench, Obj);                                   \
+    VECTOR_BENCHMARK_FOR_TYPE(bench, Pod256)
+
+VECTOR_BENCHMARK(BM_PushBack);
+VECTOR_BENCHMARK(BM_EmplaceBack);
+VECTOR_BENCHMARK(BM_ReserveFill);
+VECTOR_BENCHMARK(BM_UncheckedFill);
+VECTOR_BENCHMARK(BM_GrowByPacket);
+VECTOR_BENCHMARK(BM_InsertEraseMiddle);
+VECTOR_BENCHMARK(BM_CopyAssign);
+VECTOR_BENCHMARK(BM_Resize);
+
+BENCHMARK_TEMPLATE(BM_ShortLivedVectors, std::allocator<int>)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK_TEMPLATE(BM_ShortLivedVectors, PooledAllocator<int>)->RangeMultiplier(4)->Range(4, 4096);
+
+BENCHMARK_TEMPLATE(BM_SetLookup, std::set<int>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_SetLookup, FlatSet<int>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_SetLookup, FlatSet<int>, true)->Apply(Sizes);
+
+BENCHMARK_TEMPLATE(BM_Fifo, Vector<int>)->Apply(Sizes);
+BENCHMARK_TEMPLATE(BM_Fifo, CircularVector<int>)->Apply(Sizes);
+
+BENCHMARK_TEMPLATE(BM_PointerTraversal, false)->Arg(1 << 12)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_PointerTraversal, true)->Arg(1 << 12)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_Gather, false)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BM_Gather, true)->Arg(1 << 12)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
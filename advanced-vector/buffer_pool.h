@@ -0,0 +1,211 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <new>
+
+// Ограничения кэша одного потока. Блок, не поместившийся в них, сразу освобождается
+struct BufferPoolLimits {
+    size_t max_blocks_per_class = 32;
+    size_t max_cached_bytes = size_t(1) << 20;
+};
+
+struct BufferPoolStats {
+    // Выделения, обслуженные из кэша, и выделения, дошедшие до operator new
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t cached_blocks = 0;
+    size_t cached_bytes = 0;
+};
+
+// Кэш освобождённых блоков одного потока, разложенных по классам размеров — степеням двойки
+// от kMinBlockSize до kMaxBlockSize. Свободные блоки связаны в списки через собственную память,
+// поэтому выделение и освобождение из кэша — снятие и добавление указателя. Все блоки получены
+// из operator new, так что блок, выделенный одним потоком, можно вернуть в кэш другого.
+// При завершении потока кэш освобождается, а поздние освобождения идут мимо него
+class BufferPool {
+public:
+    static constexpr size_t kMinBlockShift = 5;
+    static constexpr size_t kMaxBlockShift = 16;
+    static constexpr size_t kMinBlockSize = size_t(1) << kMinBlockShift;
+    static constexpr size_t kMaxBlockSize = size_t(1) << kMaxBlockShift;
+    static constexpr size_t kClassCount = kMaxBlockShift - kMinBlockShift + 1;
+
+    constexpr BufferPool() noexcept = default;
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    static BufferPool& ThisThread() noexcept {
+        // Кэш тривиально разрушаем и инициализируется константой, а очищает его отдельный страж:
+        // обращения после разрушения стража остаются корректными
+        thread_local constinit BufferPool pool;
+        thread_local FlushOnThreadExit guard{pool};
+        return pool;
+    }
+
+    [[nodiscard]] static constexpr bool IsPooled(size_t bytes) noexcept {
+        return bytes <= kMaxBlockSize;
+    }
+
+    // Наименьший класс, в который помещается bytes; bytes не больше kMaxBlockSize
+    [[nodiscard]] static constexpr size_t SizeClass(size_t bytes) noexcept {
+        size_t size_class = 0;
+        while ((kMinBlockSize << size_class) < bytes) {
+            ++size_class;
+        }
+        return size_class;
+    }
+
+    [[nodiscard]] static constexpr size_t ClassSize(size_t size_class) noexcept {
+        return kMinBlockSize << size_class;
+    }
+
+    void* Allocate(size_t size_class) {
+        if (FreeBlock* block = heads_[size_class]) {
+            heads_[size_class] = block->next;
+            --counts_[size_class];
+            cached_bytes_ -= ClassSize(size_class);
+            ++hits_;
+            return block;
+        }
+        ++misses_;
+        return operator new(ClassSize(size_class));
+    }
+
+    void Deallocate(void* ptr, size_t size_class) noexcept {
+        const size_t size = ClassSize(size_class);
+        if (shut_down_ || counts_[size_class] >= limits_.max_blocks_per_class
+            || cached_bytes_ + size > limits_.max_cached_bytes) {
+            operator delete(ptr, size);
+            return;
+        }
+        heads_[size_class] = ::new (ptr) FreeBlock{heads_[size_class]};
+        ++counts_[size_class];
+        cached_bytes_ += size;
+    }
+
+    // Освобождает все блоки кэша
+    void Flush() noexcept {
+        for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+            TrimClass(size_class, 0);
+        }
+    }
+
+    // Новые ограничения применяются сразу: лишние блоки освобождаются
+    void SetLimits(const BufferPoolLimits& limits) noexcept {
+        limits_ = limits;
+        for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+            TrimClass(size_class, limits_.max_blocks_per_class);
+        }
+        // Сначала освобождаются крупные блоки
+        for (size_t size_class = kClassCount; size_class-- > 0;) {
+            while (cached_bytes_ > limits_.max_cached_bytes && counts_[size_class] > 0) {
+                TrimClass(size_class, counts_[size_class] - 1);
+            }
+        }
+    }
+
+    [[nodiscard]] const BufferPoolLimits& GetLimits() const noexcept {
+        return limits_;
+    }
+
+    [[nodiscard]] BufferPoolStats GetStats() const noexcept {
+        BufferPoolStats stats{hits_, misses_, 0, cached_bytes_};
+        for (size_t count : counts_) {
+            stats.cached_blocks += count;
+        }
+        return stats;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct FlushOnThreadExit {
+        BufferPool& pool;
+
+        ~FlushOnThreadExit() {
+            pool.shut_down_ = true;
+            pool.Flush();
+        }
+    };
+
+    FreeBlock* heads_[kClassCount] = {};
+    size_t counts_[kClassCount] = {};
+    size_t cached_bytes_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    BufferPoolLimits limits_;
+    bool shut_down_ = false;
+
+    void TrimClass(size_t size_class, size_t max_blocks) noexcept {
+        while (counts_[size_class] > max_blocks) {
+            FreeBlock* block = heads_[size_class];
+            heads_[size_class] = block->next;
+            --counts_[size_class];
+            cached_bytes_ -= ClassSize(size_class);
+            operator delete(block, ClassSize(size_class));
+        }
+    }
+};
+
+// Аллокатор поверх кэша текущего потока. Небольшие буферы округляются до класса размеров,
+// и вектор через allocate_at_least получает всю вместимость блока. Крупные буферы
+// выделяются и освобождаются operator new и operator delete напрямую
+template <typename T>
+class PooledAllocator {
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "pooled blocks use the default new alignment");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    PooledAllocator() = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (!BufferPool::IsPooled(bytes)) {
+            return {static_cast<T*>(operator new(bytes)), n};
+        }
+        const size_t size_class = BufferPool::SizeClass(bytes);
+        void* ptr = BufferPool::ThisThread().Allocate(size_class);
+        return {static_cast<T*>(ptr), BufferPool::ClassSize(size_class) / sizeof(T)};
+    }
+
+    // Вместимость, полученная из allocate_at_least, попадает в тот же класс размеров
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!BufferPool::IsPooled(bytes)) {
+            operator delete(ptr, bytes);
+            return;
+        }
+        BufferPool::ThisThread().Deallocate(ptr, BufferPool::SizeClass(bytes));
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const PooledAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+using PooledVector = Vector<T, PooledAllocator<T>, GrowthPolicy>;
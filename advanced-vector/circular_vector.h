@@ -0,0 +1,355 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+// Кольцевой буфер поверх RawMemory: добавление и удаление с обоих концов за O(1), без сдвига
+// элементов. Содержимое начинается с позиции head_ и может переходить через конец буфера,
+// поэтому лежит не более чем в двух непрерывных отрезках, которые возвращает AsSpans.
+// При росте элементы один раз переезжают в начало нового буфера по тем же правилам, что
+// и в Vector: побайтово для тривиально перемещаемых типов, иначе перемещением или копированием
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class CircularVector {
+    template <bool kConst>
+    class Iterator {
+        using Owner = std::conditional_t<kConst, const CircularVector, CircularVector>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<kConst, const T*, T*>;
+        using reference = std::conditional_t<kConst, const T&, T&>;
+
+        Iterator() = default;
+
+        Iterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        operator Iterator<true>() const noexcept {
+            return {owner_, index_};
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return owner_ == other.owner_ && index_ == other.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    CircularVector() = default;
+
+    explicit CircularVector(const Allocator& alloc) noexcept
+        : data_(alloc) {
+    }
+
+    CircularVector(std::initializer_list<T> init, const Allocator& alloc = Allocator())
+        : data_(init.size(), alloc) {
+        vector_detail::UninitializedCopyN(init.begin(), init.size(), data_.GetAddress());
+        size_ = init.size();
+    }
+
+    CircularVector(const CircularVector& other)
+        : data_(other.size_, std::allocator_traits<Allocator>::select_on_container_copy_construction(
+                                 other.data_.GetAllocator())) {
+        const auto [first, second] = other.AsSpans();
+        vector_detail::UninitializedCopyN(first.data(), first.size(), data_.GetAddress());
+        try {
+            vector_detail::UninitializedCopyN(second.data(), second.size(), data_.GetAddress() + first.size());
+        }
+        catch (...) {
+            std::destroy_n(data_.GetAddress(), first.size());
+            throw;
+        }
+        size_ = other.size_;
+    }
+
+    CircularVector(CircularVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , head_(std::exchange(other.head_, 0))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    CircularVector& operator=(const CircularVector& rhs) {
+        if (this != &rhs) {
+            CircularVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    CircularVector& operator=(CircularVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            data_ = std::move(rhs.data_);
+            head_ = std::exchange(rhs.head_, 0);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~CircularVector() {
+        Clear();
+    }
+
+    void Swap(CircularVector& other) noexcept {
+        data_.Swap(other.data_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // index отсчитывается от первого элемента
+    const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[Physical(index)];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[Physical(index)];
+    }
+
+    T& Front() noexcept {
+        assert(size_ != 0);
+        return data_[head_];
+    }
+
+    const T& Front() const noexcept {
+        assert(size_ != 0);
+        return data_[head_];
+    }
+
+    T& Back() noexcept {
+        assert(size_ != 0);
+        return data_[Physical(size_ - 1)];
+    }
+
+    const T& Back() const noexcept {
+        assert(size_ != 0);
+        return data_[Physical(size_ - 1)];
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    // Содержимое по порядку: второй отрезок пуст, если элементы не переходят через конец буфера
+    std::pair<std::span<T>, std::span<T>> AsSpans() noexcept {
+        const size_t first_size = std::min(size_, Capacity() - head_);
+        return {std::span<T>(data_ + head_, first_size), std::span<T>(data_ + 0, size_ - first_size)};
+    }
+
+    std::pair<std::span<const T>, std::span<const T>> AsSpans() const noexcept {
+        const size_t first_size = std::min(size_, Capacity() - head_);
+        return {std::span<const T>(data_ + head_, first_size), std::span<const T>(data_ + 0, size_ - first_size)};
+    }
+
+    // Делает содержимое непрерывным, переезжая в новый буфер той же вместимости, если нужно
+    std::span<T> Linearize() {
+        if (head_ + size_ > Capacity()) {
+            Reallocate(Capacity());
+        }
+        return AsSpans().first;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    void Clear() noexcept {
+        const auto [first, second] = AsSpans();
+        std::destroy(first.begin(), first.end());
+        std::destroy(second.begin(), second.end());
+        head_ = 0;
+        size_ = 0;
+    }
+
+    template <typename T1>
+    void PushBack(T1&& value) {
+        EmplaceBack(std::forward<T1>(value));
+    }
+
+    template <typename T1>
+    void PushFront(T1&& value) {
+        EmplaceFront(std::forward<T1>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) [[unlikely]] {
+            return GrowAndEmplace(size_, std::forward<Args>(args)...);
+        }
+        T* slot = std::construct_at(data_ + Physical(size_), std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    template <typename... Args>
+    T& EmplaceFront(Args&&... args) {
+        if (size_ == Capacity()) [[unlikely]] {
+            return GrowAndEmplace(0, std::forward<Args>(args)...);
+        }
+        const size_t new_head = head_ == 0 ? Capacity() - 1 : head_ - 1;
+        T* slot = std::construct_at(data_ + new_head, std::forward<Args>(args)...);
+        head_ = new_head;
+        ++size_;
+        return *slot;
+    }
+
+    void PopFront() noexcept {
+        assert(size_ != 0);
+        std::destroy_at(data_ + head_);
+        head_ = Physical(1);
+        --size_;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        std::destroy_at(data_ + Physical(size_ - 1));
+        --size_;
+    }
+
+    friend bool operator==(const CircularVector& lhs, const CircularVector& rhs)
+        requires std::equality_comparable<T>
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    RawMemory<T, Allocator> data_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+    // Вместимость не обязана быть степенью двойки, поэтому вместо маски — одно вычитание
+    size_t Physical(size_t index) const noexcept {
+        const size_t position = head_ + index;
+        return position >= Capacity() ? position - Capacity() : position;
+    }
+
+    size_t CalculateGrowth(size_t min_capacity) const noexcept {
+        const size_t new_capacity = GrowthPolicy::NewCapacity(Capacity(), min_capacity, sizeof(T));
+        assert(new_capacity >= min_capacity);
+        return new_capacity;
+    }
+
+    // Переносит элементы по порядку в начало dst. При исключении исходный буфер не меняется
+    void RelocateTo(T* dst) {
+        const auto [first, second] = AsSpans();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            vector_detail::RelocateBitwise(first.data(), first.size(), dst);
+            vector_detail::RelocateBitwise(second.data(), second.size(), dst + first.size());
+        }
+        else {
+            vector_detail::UninitializedMoveOrCopyN(first.data(), first.size(), dst);
+            try {
+                vector_detail::UninitializedMoveOrCopyN(second.data(), second.size(), dst + first.size());
+            }
+            catch (...) {
+                std::destroy_n(dst, first.size());
+                throw;
+            }
+            std::destroy(first.begin(), first.end());
+            std::destroy(second.begin(), second.end());
+        }
+    }
+
+    void Reallocate(size_t new_capacity) {
+        RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+        RelocateTo(new_data.GetAddress());
+        data_.Swap(new_data);
+        head_ = 0;
+    }
+
+    // Новый элемент создаётся в новом буфере до переезда: аргументы могут ссылаться
+    // на элементы этого же вектора. pos — 0 для вставки в начало или size_ для вставки в конец
+    template <typename... Args>
+    ADVANCED_VECTOR_COLD T& GrowAndEmplace(size_t pos, Args&&... args) {
+        RawMemory<T, Allocator> new_data(CalculateGrowth(size_ + 1), data_.GetAllocator());
+        T* slot = std::construct_at(new_data + pos, std::forward<Args>(args)...);
+        try {
+            RelocateTo(new_data.GetAddress() + (pos == 0 ? 1 : 0));
+        }
+        catch (...) {
+            std::destroy_at(slot);
+            throw;
+        }
+        data_.Swap(new_data);
+        head_ = 0;
+        ++size_;
+        return *slot;
+    }
+};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace concurrent_vector_detail {
+
+inline size_t FloorLog2(size_t value) noexcept {
+    assert(value != 0);
+#if defined(__GNUC__)
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value);
+#else
+    size_t result = 0;
+    while (value > 1) {
+        value /= 2;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+}  // namespace concurrent_vector_detail
+
+// Вектор только для добавления, в который могут одновременно писать несколько потоков.
+// Элементы лежат в сегментах удваивающегося размера: сегмент 0 вмещает 2^kFirstSegmentShift
+// элементов, сегмент k > 0 — столько же, сколько все предыдущие вместе. Место под элемент
+// резервируется атомарным fetch_add, сегмент устанавливается через compare_exchange тем потоком,
+// который первым до него дошёл, поэтому опубликованные элементы никогда не переезжают.
+//
+// Элемент опубликован, когда вернулся EmplaceBack/GrowBy, создавший его; индекс передаётся
+// читателю любым способом синхронизации (join, мьютекс, release/acquire). operator[] для
+// опубликованного индекса не ждёт и не блокируется. Size() считает и зарезервированные, но ещё
+// создаваемые элементы, поэтому обходить вектор до Size() безопасно только после завершения
+// всех писателей. Аллокатор вызывается из разных потоков и должен это допускать
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static constexpr size_t kFirstSegmentShift = 5;
+    static constexpr size_t kMaxSegments = sizeof(size_t) * 8 - kFirstSegmentShift + 1;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        const size_t size = size_.load(std::memory_order_relaxed);
+        for (size_t index = 0; index < size; ++index) {
+            if (!IsHole(index)) {
+                std::destroy_at(Slot(index));
+            }
+        }
+        for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+            if (T* data = segments_[segment].load(std::memory_order_relaxed)) {
+                AllocTraits::deallocate(alloc_, data, SegmentSize(segment));
+            }
+        }
+    }
+
+    // Создаёт элемент в конце и возвращает его индекс
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        const size_t segment = SegmentOf(index);
+        try {
+            new (EnsureSegment(segment) + (index - SegmentBase(segment))) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            MarkHole(index, 1);
+            throw;
+        }
+        return index;
+    }
+
+    template <typename T1>
+    size_t PushBack(T1&& value) {
+        return EmplaceBack(std::forward<T1>(value));
+    }
+
+    // Резервирует одним fetch_add n идущих подряд индексов для вызывающего потока, создаёт
+    // в них элементы инициализацией значением и возвращает первый индекс. Пачка может
+    // пересекать границу сегментов, поэтому в памяти она непрерывна только по частям
+    size_t GrowBy(size_t n) {
+        const size_t first = size_.fetch_add(n, std::memory_order_relaxed);
+        size_t constructed = 0;
+        try {
+            while (constructed < n) {
+                const size_t index = first + constructed;
+                const size_t segment = SegmentOf(index);
+                const size_t offset = index - SegmentBase(segment);
+                const size_t count = std::min(n - constructed, SegmentSize(segment) - offset);
+                std::uninitialized_value_construct_n(EnsureSegment(segment) + offset, count);
+                constructed += count;
+            }
+        }
+        catch (...) {
+            // uninitialized_value_construct_n сам уничтожает созданную часть своего куска
+            while (constructed > 0) {
+                --constructed;
+                std::destroy_at(Slot(first + constructed));
+            }
+            MarkHole(first, n);
+            throw;
+        }
+        return first;
+    }
+
+    // Заранее выделяет сегменты под capacity элементов. Можно вызывать параллельно с добавлением
+    void Reserve(size_t capacity) {
+        if (capacity != 0) {
+            const size_t last_segment = SegmentOf(capacity - 1);
+            for (size_t segment = 0; segment <= last_segment; ++segment) {
+                EnsureSegment(segment);
+            }
+        }
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_.load(std::memory_order_relaxed));
+        return *Slot(index);
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        size_t capacity = 0;
+        for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+            if (segments_[segment].load(std::memory_order_acquire) == nullptr) {
+                break;
+            }
+            capacity = SegmentBase(segment) + SegmentSize(segment);
+        }
+        return capacity;
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    std::atomic<T*> segments_[kMaxSegments] = {};
+    std::atomic<size_t> size_ = 0;
+    [[no_unique_address]] Allocator alloc_;
+
+    // Индексы, элементы которых не удалось создать из-за исключения. Такие индексы никому
+    // не возвращались, деструктор их пропускает. Обращение к списку — только на редком пути
+    std::mutex holes_mutex_;
+    Vector<std::pair<size_t, size_t>> holes_;
+    std::atomic<bool> has_holes_ = false;
+
+    static size_t SegmentOf(size_t index) noexcept {
+        return (index >> kFirstSegmentShift) == 0
+            ? 0
+            : concurrent_vector_detail::FloorLog2(index) - kFirstSegmentShift + 1;
+    }
+
+    static size_t SegmentBase(size_t segment) noexcept {
+        return segment == 0 ? 0 : size_t(1) << (kFirstSegmentShift + segment - 1);
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return segment == 0 ? size_t(1) << kFirstSegmentShift : SegmentBase(segment);
+    }
+
+    T* Slot(size_t index) const noexcept {
+        const size_t segment = SegmentOf(index);
+        T* data = segments_[segment].load(std::memory_order_acquire);
+        assert(data != nullptr);
+        return data + (index - SegmentBase(segment));
+    }
+
+    // Возвращает сегмент, при необходимости выделяя его. Если сегмент одновременно
+    // установил другой поток, своя память освобождается
+    T* EnsureSegment(size_t segment) {
+        T* data = segments_[segment].load(std::memory_order_acquire);
+        if (data != nullptr) {
+            return data;
+        }
+        T* new_data = AllocTraits::allocate(alloc_, SegmentSize(segment));
+        if (segments_[segment].compare_exchange_strong(data, new_data, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+            return new_data;
+        }
+        AllocTraits::deallocate(alloc_, new_data, SegmentSize(segment));
+        return data;
+    }
+
+    void MarkHole(size_t first, size_t count) noexcept {
+        std::lock_guard guard(holes_mutex_);
+        try {
+            holes_.EmplaceBack(first, count);
+        }
+        catch (...) {
+            // Без записи о дыре деструктор уничтожил бы несозданные объекты
+            std::terminate();
+        }
+        has_holes_.store(true, std::memory_order_relaxed);
+    }
+
+    bool IsHole(size_t index) const noexcept {
+        if (!has_holes_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        for (const auto& [first, count] : holes_) {
+            if (index >= first && index - first < count) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
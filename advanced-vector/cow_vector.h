@@ -0,0 +1,278 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+// Вектор с разделяемым буфером и копированием при записи. Копия CowVector — увеличение
+// счётчика ссылок, а собственная копия элементов создаётся при первом изменении разделяемого
+// вектора. Чтение через const-методы и Get() никогда не копирует элементы, а неконстантные
+// operator[], begin и end считаются изменением и отделяют буфер.
+//
+// Разные экземпляры, разделяющие буфер, можно читать и изменять из разных потоков без
+// синхронизации; один экземпляр — как обычный вектор. Итераторы и ссылки, полученные через
+// const-путь, становятся недействительными после изменения этого экземпляра.
+//
+// Через неконстантную ссылку или итератор, полученные до копирования, нельзя изменить копию:
+// пока такие ссылки могут быть действительны (до перевыделения буфера), копирование этого
+// экземпляра сразу копирует элементы, а не разделяет буфер. Ссылки на элементы выдают
+// неконстантные operator[], begin и end, EmplaceBack и Erase; PushBack их не выдаёт.
+// Ссылка на весь вектор из Mutable переживает и перевыделение, поэтому после Mutable
+// экземпляр копирует элементы при каждом копировании, пока не отпустит этот буфер
+// присваиванием, перемещением или Clear разделяемого вектора
+template <typename T, typename Allocator = std::allocator<T>>
+class CowVector {
+public:
+    using value_type = T;
+    using VectorType = Vector<T, Allocator>;
+    using iterator = typename VectorType::iterator;
+    using const_iterator = typename VectorType::const_iterator;
+
+    CowVector() noexcept = default;
+
+    explicit CowVector(VectorType items)
+        : shared_(new Shared{std::move(items)}) {
+    }
+
+    CowVector(std::initializer_list<T> init)
+        : CowVector(VectorType(init)) {
+    }
+
+    CowVector(const CowVector& other)
+        : shared_(other.Share()) {
+    }
+
+    CowVector(CowVector&& other) noexcept
+        : shared_(std::exchange(other.shared_, nullptr)) {
+    }
+
+    CowVector& operator=(const CowVector& rhs) {
+        if (shared_ != rhs.shared_) {
+            CowVector(rhs).Swap(*this);
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Release();
+            shared_ = std::exchange(rhs.shared_, nullptr);
+        }
+        return *this;
+    }
+
+    ~CowVector() {
+        Release();
+    }
+
+    void Swap(CowVector& other) noexcept {
+        std::swap(shared_, other.shared_);
+    }
+
+    // Путь чтения: ссылка на разделяемый вектор без копирования
+    [[nodiscard]] const VectorType& Get() const noexcept {
+        static const VectorType empty;
+        return shared_ != nullptr ? shared_->items : empty;
+    }
+
+    // Путь записи: после вызова буфер принадлежит только этому экземпляру
+    [[nodiscard]] VectorType& Mutable() {
+        VectorType& items = MutableItems();
+        shared_->leaked_vector = true;
+        return items;
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return Get().Size();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return Size() == 0;
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        return Get().Capacity();
+    }
+
+    // Сколько экземпляров разделяют буфер; 0 у пустого вектора без буфера
+    [[nodiscard]] size_t UseCount() const noexcept {
+        return shared_ != nullptr ? shared_->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return Get()[index];
+    }
+
+    T& operator[](size_t index) {
+        assert(index < Size());
+        return MutableItems()[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return Get().begin();
+    }
+
+    const_iterator end() const noexcept {
+        return Get().end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return Get().cbegin();
+    }
+
+    const_iterator cend() const noexcept {
+        return Get().cend();
+    }
+
+    iterator begin() {
+        return MutableItems().begin();
+    }
+
+    iterator end() {
+        return MutableItems().end();
+    }
+
+    template <typename T1>
+    void PushBack(T1&& value) {
+        AppendElement(std::forward<T1>(value));
+    }
+
+    // Аргументы могут ссылаться на элементы этого же вектора
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        T& element = AppendElement(std::forward<Args>(args)...);
+        Leak();
+        return element;
+    }
+
+    void PopBack() {
+        assert(!Empty());
+        Detach();
+        shared_->items.PopBack();
+    }
+
+    // pos может указывать в разделяемый буфер, поэтому переводится в индекс до отделения
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - cbegin();
+        VectorType& items = MutableItems();
+        return items.Erase(items.cbegin() + index);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t first_index = first - cbegin();
+        const size_t last_index = last - cbegin();
+        VectorType& items = MutableItems();
+        return items.Erase(items.cbegin() + first_index, items.cbegin() + last_index);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Detach();
+        shared_->items.Reserve(new_capacity);
+    }
+
+    void Resize(size_t new_size) {
+        Detach();
+        shared_->items.Resize(new_size);
+    }
+
+    // Разделяемый буфер не копируется, а только отпускается
+    void Clear() noexcept {
+        if (IsUnique()) {
+            shared_->items.Clear();
+        }
+        else {
+            Release();
+        }
+    }
+
+    friend bool operator==(const CowVector& lhs, const CowVector& rhs)
+        requires std::equality_comparable<T>
+    {
+        return lhs.shared_ == rhs.shared_ || lhs.Get() == rhs.Get();
+    }
+
+private:
+    struct Shared {
+        VectorType items;
+        std::atomic<size_t> refs{1};
+        // Наружу выданы неконстантные ссылки на элементы буфера leaked_buffer. Поля меняются
+        // только у единственного владельца, поэтому атомарность им не нужна
+        bool leaked = false;
+        const T* leaked_buffer = nullptr;
+        // Наружу выдана ссылка на сам вектор: она не теряет силу при перевыделении
+        bool leaked_vector = false;
+    };
+
+    Shared* shared_ = nullptr;
+
+    // acquire: изменять буфер можно только после того, как прежние владельцы его отпустили
+    bool IsUnique() const noexcept {
+        return shared_ != nullptr && shared_->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    // После перевыделения выданные ссылки на элементы недействительны, и буфер снова можно
+    // разделять. Ссылка на вектор из Mutable действительна, пока жив сам Shared
+    bool IsShareable() const noexcept {
+        return !shared_->leaked_vector
+               && (!shared_->leaked || shared_->leaked_buffer != shared_->items.cbegin());
+    }
+
+    void Leak() noexcept {
+        shared_->leaked = true;
+        shared_->leaked_buffer = shared_->items.begin();
+    }
+
+    VectorType& MutableItems() {
+        Detach();
+        Leak();
+        return shared_->items;
+    }
+
+    Shared* Share() const {
+        if (shared_ == nullptr) {
+            return nullptr;
+        }
+        if (!IsShareable()) {
+            return Clone();
+        }
+        shared_->refs.fetch_add(1, std::memory_order_relaxed);
+        return shared_;
+    }
+
+    void Detach() {
+        if (!IsUnique()) [[unlikely]] {
+            Shared* copy = Clone();
+            Release();
+            shared_ = copy;
+        }
+    }
+
+    // Разделяемый буфер отпускается только после вставки: аргументы могут ссылаться на его
+    // элементы, а свой буфер Vector обрабатывает сам
+    template <typename... Args>
+    T& AppendElement(Args&&... args) {
+        CowVector previous;
+        if (!IsUnique()) [[unlikely]] {
+            Shared* copy = Clone();
+            previous.shared_ = std::exchange(shared_, copy);
+        }
+        return shared_->items.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    ADVANCED_VECTOR_COLD Shared* Clone() const {
+        return shared_ != nullptr ? new Shared{shared_->items} : new Shared{};
+    }
+
+    void Release() noexcept {
+        // acq_rel: последний владелец видит все записи прежних владельцев до удаления буфера
+        if (shared_ != nullptr && shared_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete shared_;
+        }
+        shared_ = nullptr;
+    }
+};
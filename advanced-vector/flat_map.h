@@ -0,0 +1,488 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace flat_map_detail {
+
+// lower_bound без ветвлений: на каждом шаге диапазон сокращается вдвое условным сдвигом
+// начала, который компилятор превращает в cmov, и предсказателю переходов нечего угадывать
+template <typename K, typename Compare>
+size_t BranchlessLowerBound(const K* data, size_t size, const K& key, const Compare& comp) {
+    if (size == 0) {
+        return 0;
+    }
+    const K* base = data;
+    size_t length = size;
+    while (length > 1) {
+        const size_t half = length / 2;
+        base = comp(base[half], key) ? base + half : base;
+        length -= half;
+    }
+    return static_cast<size_t>(base - data) + static_cast<size_t>(comp(*base, key));
+}
+
+// Копия отсортированных ключей в порядке Эйтцингера: корень в ячейке 1, потомки узла k —
+// в ячейках 2k и 2k + 1. Первые уровни дерева лежат рядом и остаются в кэше, а спуск
+// по дереву читает память последовательно по уровням. Для каждой ячейки хранится позиция
+// ключа в отсортированном массиве
+template <typename K>
+class EytzingerIndex {
+public:
+    [[nodiscard]] bool IsBuilt() const noexcept {
+        return keys_.Size() != 0;
+    }
+
+    void Build(const Vector<K>& sorted) {
+        Clear();
+        if (sorted.Size() == 0) {
+            return;
+        }
+        // Ячейка 0 не используется и заполняется только ради плотного массива
+        keys_.Insert(keys_.cend(), sorted.Size() + 1, sorted[0]);
+        positions_.Resize(sorted.Size() + 1);
+        size_t next = 0;
+        Fill(sorted, 1, next);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        positions_.Clear();
+    }
+
+    // Позиция первого ключа не меньше key в отсортированном массиве
+    template <typename Compare>
+    size_t LowerBound(const K& key, const Compare& comp) const {
+        const size_t size = keys_.Size() - 1;
+        size_t k = 1;
+        while (k <= size) {
+#if defined(__GNUC__)
+            // Потомки узла k через log2(kBlock) уровней лежат в одной строке кэша: она
+            // загружается заранее, пока идут сравнения на промежуточных уровнях
+            __builtin_prefetch(keys_.begin() + std::min(k * kBlock, size));
+#endif
+            k = 2 * k + static_cast<size_t>(comp(keys_[k], key));
+        }
+        // Последний поворот налево указывает на ответ: убираем хвост поворотов направо
+        k >>= std::countr_one(k) + 1;
+        return k == 0 ? size : positions_[k];
+    }
+
+private:
+    static constexpr size_t kBlock = sizeof(K) < 64 ? 64 / sizeof(K) : 1;
+
+    Vector<K> keys_;
+    Vector<size_t> positions_;
+
+    void Fill(const Vector<K>& sorted, size_t k, size_t& next) {
+        if (k >= keys_.Size()) {
+            return;
+        }
+        Fill(sorted, 2 * k, next);
+        keys_[k] = sorted[next];
+        positions_[k] = next++;
+        Fill(sorted, 2 * k + 1, next);
+    }
+};
+
+// Сливает sorted со вставками added в пустой merged, вместимости которого хватает на всё:
+// added[j] встаёт перед sorted[positions[j]]. sorted копируется, если перемещение может
+// бросить, поэтому при исключении sorted не меняется, а с noexcept-перемещением слияние
+// не бросает вовсе. Некопируемый T с бросающим перемещением, как в UninitializedMoveOrCopyN,
+// перемещается и даёт лишь базовую гарантию
+template <typename T>
+void MergeInto(Vector<T>& sorted, Vector<T>& added, const Vector<size_t>& positions, Vector<T>& merged) {
+    assert(merged.Size() == 0 && merged.Capacity() >= sorted.Size() + added.Size());
+    size_t pos = 0;
+    for (size_t j = 0; j < added.Size(); ++j) {
+        for (; pos < positions[j]; ++pos) {
+            merged.UncheckedEmplaceBack(std::move_if_noexcept(sorted[pos]));
+        }
+        merged.UncheckedEmplaceBack(std::move(added[j]));
+    }
+    for (; pos < sorted.Size(); ++pos) {
+        merged.UncheckedEmplaceBack(std::move_if_noexcept(sorted[pos]));
+    }
+}
+
+}  // namespace flat_map_detail
+
+// Множество на отсортированном Vector: поиск идёт по непрерывному массиву без узлов и указателей.
+// Одиночные вставка и удаление стоят O(n), поэтому наборы ключей добавляются через InsertSorted —
+// одно слияние вместо вставки каждого ключа. BuildIndex строит копию ключей в порядке Эйтцингера
+// для интенсивного чтения; любое изменение множества сбрасывает её, и поиск возвращается
+// к двоичному
+template <typename K, typename Compare = std::less<K>>
+class FlatSet {
+public:
+    using value_type = K;
+    using const_iterator = const K*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        return keys_.Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        index_.Clear();
+    }
+
+    [[nodiscard]] const Vector<K>& Keys() const noexcept {
+        return keys_;
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    const_iterator LowerBound(const K& key) const {
+        return keys_.begin() + LowerBoundIndex(key);
+    }
+
+    const_iterator Find(const K& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return IsKeyAt(index, key) ? keys_.begin() + index : keys_.end();
+    }
+
+    [[nodiscard]] bool Contains(const K& key) const {
+        return IsKeyAt(LowerBoundIndex(key), key);
+    }
+
+    std::pair<const_iterator, bool> Insert(const K& key) {
+        const size_t index = LowerBoundIndex(key);
+        if (IsKeyAt(index, key)) {
+            return {keys_.begin() + index, false};
+        }
+        index_.Clear();
+        return {keys_.Insert(keys_.cbegin() + index, key), true};
+    }
+
+    // Добавляет отсортированный диапазон ключей за одно слияние. Ключи, уже лежащие
+    // в множестве или повторяющиеся в диапазоне, пропускаются
+    template <typename InputIt>
+    void InsertSorted(InputIt first, InputIt last) {
+        index_.Clear();
+        if constexpr (vector_detail::IsForwardIterator<InputIt>::value) {
+            assert(std::is_sorted(first, last, comp_));
+            // Частый случай — ключи продолжают множество: диапазон дописывается в конец целиком
+            if (first == last) {
+                return;
+            }
+            if ((Empty() || comp_(keys_[Size() - 1], *first))
+                && std::adjacent_find(first, last, [this](const K& lhs, const K& rhs) {
+                       return !comp_(lhs, rhs);
+                   }) == last) {
+                keys_.Insert(keys_.cend(), first, last);
+                return;
+            }
+        }
+        // Сначала из диапазона отбираются новые ключи и их позиции, и лишь потом ключи
+        // множества переносятся в слияние: копирование ключей из диапазона и сравнения
+        // бросают до того, как множество затронуто
+        Vector<K> added;
+        Vector<size_t> positions;
+        size_t pos = 0;
+        for (; first != last; ++first) {
+            const K& key = *first;
+            while (pos < Size() && comp_(keys_[pos], key)) {
+                ++pos;
+            }
+            if ((pos < Size() && !comp_(key, keys_[pos]))
+                || (added.Size() != 0 && !comp_(added[added.Size() - 1], key))) {
+                continue;
+            }
+            added.PushBack(key);
+            positions.PushBack(pos);
+        }
+        if (added.Size() != 0) {
+            Vector<K> merged;
+            merged.Reserve(Size() + added.Size());
+            flat_map_detail::MergeInto(keys_, added, positions, merged);
+            keys_.Swap(merged);
+        }
+    }
+
+    template <typename Range>
+    void InsertSorted(const Range& range) {
+        InsertSorted(std::begin(range), std::end(range));
+    }
+
+    size_t Erase(const K& key) {
+        const size_t index = LowerBoundIndex(key);
+        if (!IsKeyAt(index, key)) {
+            return 0;
+        }
+        index_.Clear();
+        keys_.Erase(keys_.cbegin() + index);
+        return 1;
+    }
+
+    void BuildIndex() {
+        index_.Build(keys_);
+    }
+
+    [[nodiscard]] bool HasIndex() const noexcept {
+        return index_.IsBuilt();
+    }
+
+private:
+    Vector<K> keys_;
+    flat_map_detail::EytzingerIndex<K> index_;
+    [[no_unique_address]] Compare comp_;
+
+    size_t LowerBoundIndex(const K& key) const {
+        if (index_.IsBuilt()) {
+            return index_.LowerBound(key, comp_);
+        }
+        return flat_map_detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    bool IsKeyAt(size_t index, const K& key) const {
+        return index < keys_.Size() && !comp_(key, keys_[index]);
+    }
+};
+
+// Отображение на двух отсортированных параллельно Vector: ключи лежат отдельно от значений,
+// поэтому поиск читает только плотный массив ключей. Устроено как FlatSet, а значение ключа
+// с индексом i лежит в Values()[i]
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        return std::min(keys_.Capacity(), values_.Capacity());
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+        index_.Clear();
+    }
+
+    [[nodiscard]] const Vector<K>& Keys() const noexcept {
+        return keys_;
+    }
+
+    [[nodiscard]] const Vector<V>& Values() const noexcept {
+        return values_;
+    }
+
+    [[nodiscard]] bool Contains(const K& key) const {
+        return IsKeyAt(LowerBoundIndex(key), key);
+    }
+
+    // nullptr, если ключа нет
+    V* Find(const K& key) {
+        const size_t index = LowerBoundIndex(key);
+        return IsKeyAt(index, key) ? &values_[index] : nullptr;
+    }
+
+    const V* Find(const K& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return IsKeyAt(index, key) ? &values_[index] : nullptr;
+    }
+
+    V& At(const K& key) {
+        return const_cast<V&>(std::as_const(*this).At(key));
+    }
+
+    const V& At(const K& key) const {
+        if (const V* value = Find(key)) {
+            return *value;
+        }
+        throw std::out_of_range("FlatMap::At: key not found");
+    }
+
+    V& operator[](const K& key) {
+        return *TryEmplace(key).first;
+    }
+
+    // Значение создаётся из args только для нового ключа
+    template <typename... Args>
+    std::pair<V*, bool> TryEmplace(const K& key, Args&&... args) {
+        const size_t index = LowerBoundIndex(key);
+        if (IsKeyAt(index, key)) {
+            return {&values_[index], false};
+        }
+        index_.Clear();
+        values_.Emplace(values_.cbegin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Insert(keys_.cbegin() + index, key);
+        }
+        catch (...) {
+            values_.Erase(values_.cbegin() + index);
+            throw;
+        }
+        return {&values_[index], true};
+    }
+
+    std::pair<V*, bool> Insert(const K& key, const V& value) {
+        return TryEmplace(key, value);
+    }
+
+    // Добавляет отсортированный по ключам диапазон пар за одно слияние. Для ключей, уже
+    // лежащих в отображении или повторяющихся в диапазоне, остаётся первое значение
+    template <typename InputIt>
+    void InsertSorted(InputIt first, InputIt last) {
+        index_.Clear();
+        if constexpr (vector_detail::IsForwardIterator<InputIt>::value) {
+            assert(std::is_sorted(first, last, [this](const auto& lhs, const auto& rhs) {
+                return comp_(lhs.first, rhs.first);
+            }));
+            if (first == last) {
+                return;
+            }
+            if ((Empty() || comp_(keys_[Size() - 1], first->first))
+                && std::adjacent_find(first, last, [this](const auto& lhs, const auto& rhs) {
+                       return !comp_(lhs.first, rhs.first);
+                   }) == last) {
+                AppendSorted(first, last);
+                return;
+            }
+        }
+        // Как в FlatSet::InsertSorted, но слияний два. Оба буфера выделяются заранее, и первым
+        // идёт слияние, которое может бросить: второе, перемещающее с noexcept, уже не бросит
+        // и не оставит перемещённых элементов после исключения
+        Vector<K> added_keys;
+        Vector<V> added_values;
+        Vector<size_t> positions;
+        size_t pos = 0;
+        for (; first != last; ++first) {
+            const auto& [key, value] = *first;
+            while (pos < Size() && comp_(keys_[pos], key)) {
+                ++pos;
+            }
+            if ((pos < Size() && !comp_(key, keys_[pos]))
+                || (added_keys.Size() != 0 && !comp_(added_keys[added_keys.Size() - 1], key))) {
+                continue;
+            }
+            added_keys.PushBack(key);
+            added_values.PushBack(value);
+            positions.PushBack(pos);
+        }
+        if (added_keys.Size() != 0) {
+            Vector<K> merged_keys;
+            Vector<V> merged_values;
+            merged_keys.Reserve(Size() + added_keys.Size());
+            merged_values.Reserve(Size() + added_keys.Size());
+            if constexpr (std::is_nothrow_move_constructible_v<K>) {
+                flat_map_detail::MergeInto(values_, added_values, positions, merged_values);
+                flat_map_detail::MergeInto(keys_, added_keys, positions, merged_keys);
+            }
+            else {
+                flat_map_detail::MergeInto(keys_, added_keys, positions, merged_keys);
+                flat_map_detail::MergeInto(values_, added_values, positions, merged_values);
+            }
+            keys_.Swap(merged_keys);
+            values_.Swap(merged_values);
+        }
+    }
+
+    template <typename Range>
+    void InsertSorted(const Range& range) {
+        InsertSorted(std::begin(range), std::end(range));
+    }
+
+    size_t Erase(const K& key) {
+        const size_t index = LowerBoundIndex(key);
+        if (!IsKeyAt(index, key)) {
+            return 0;
+        }
+        index_.Clear();
+        keys_.Erase(keys_.cbegin() + index);
+        values_.Erase(values_.cbegin() + index);
+        return 1;
+    }
+
+    void BuildIndex() {
+        index_.Build(keys_);
+    }
+
+    [[nodiscard]] bool HasIndex() const noexcept {
+        return index_.IsBuilt();
+    }
+
+private:
+    Vector<K> keys_;
+    Vector<V> values_;
+    flat_map_detail::EytzingerIndex<K> index_;
+    [[no_unique_address]] Compare comp_;
+
+    size_t LowerBoundIndex(const K& key) const {
+        if (index_.IsBuilt()) {
+            return index_.LowerBound(key, comp_);
+        }
+        return flat_map_detail::BranchlessLowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    bool IsKeyAt(size_t index, const K& key) const {
+        return index < keys_.Size() && !comp_(key, keys_[index]);
+    }
+
+    template <typename ForwardIt>
+    void AppendSorted(ForwardIt first, ForwardIt last) {
+        Reserve(Size() + static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) {
+            keys_.PushBack(first->first);
+            try {
+                values_.PushBack(first->second);
+            }
+            catch (...) {
+                keys_.PopBack();
+                throw;
+            }
+        }
+    }
+};
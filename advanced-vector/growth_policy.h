@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+// Политика роста определяет новую вместимость вектора, когда текущей не хватает.
+// NewCapacity получает текущую вместимость, минимально необходимую вместимость
+// и размер элемента в байтах и возвращает значение не меньше min_capacity
+
+namespace growth_detail {
+
+constexpr size_t SaturatingAdd(size_t lhs, size_t rhs) noexcept {
+    return lhs > std::numeric_limits<size_t>::max() - rhs ? std::numeric_limits<size_t>::max() : lhs + rhs;
+}
+
+constexpr size_t SaturatingMul(size_t lhs, size_t rhs) noexcept {
+    return rhs != 0 && lhs > std::numeric_limits<size_t>::max() / rhs ? std::numeric_limits<size_t>::max()
+                                                                       : lhs * rhs;
+}
+
+constexpr size_t RoundUp(size_t value, size_t granularity) noexcept {
+    return SaturatingMul((SaturatingAdd(value, granularity - 1)) / granularity, granularity);
+}
+
+// Переводит размер блока из байт обратно в элементы, не опускаясь ниже min_capacity
+constexpr size_t BytesToCapacity(size_t bytes, size_t min_capacity, size_t element_size) noexcept {
+    return std::max(bytes / element_size, min_capacity);
+}
+
+}  // namespace growth_detail
+
+struct DoublingGrowth {
+    static constexpr size_t NewCapacity(size_t capacity, size_t min_capacity, size_t /*element_size*/) noexcept {
+        return std::max(growth_detail::SaturatingMul(capacity, 2), min_capacity);
+    }
+};
+
+// Рост в 1.5 раза позволяет аллокатору переиспользовать ранее освобождённые блоки
+struct OneAndHalfGrowth {
+    static constexpr size_t NewCapacity(size_t capacity, size_t min_capacity, size_t /*element_size*/) noexcept {
+        return std::max(growth_detail::SaturatingAdd(capacity, capacity / 2), min_capacity);
+    }
+};
+
+// Округляет крупные блоки до целого числа страниц, чтобы хвост последней страницы не пропадал
+template <typename BasePolicy = DoublingGrowth, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    static_assert(PageSize != 0 && (PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two");
+
+    static constexpr size_t NewCapacity(size_t capacity, size_t min_capacity, size_t element_size) noexcept {
+        const size_t base_capacity = BasePolicy::NewCapacity(capacity, min_capacity, element_size);
+        const size_t bytes = growth_detail::SaturatingMul(base_capacity, element_size);
+        if (bytes < PageSize) {
+            return base_capacity;
+        }
+        return growth_detail::BytesToCapacity(growth_detail::RoundUp(bytes, PageSize), base_capacity, element_size);
+    }
+};
+
+// Округляет размер блока до ближайшего класса размеров аллокатора (схема jemalloc/tcmalloc:
+// четыре класса на каждый интервал между степенями двойки), чтобы не терять выделенный остаток
+template <typename BasePolicy = DoublingGrowth>
+struct SizeClassGrowth {
+    static constexpr size_t SizeClass(size_t bytes) noexcept {
+        constexpr size_t kQuantum = 16;
+        if (bytes <= 4 * kQuantum) {
+            return growth_detail::RoundUp(bytes, kQuantum);
+        }
+        size_t power = 4 * kQuantum;
+        while (power <= (bytes - 1) / 2) {
+            power *= 2;
+        }
+        return growth_detail::RoundUp(bytes, power / 4);
+    }
+
+    static constexpr size_t NewCapacity(size_t capacity, size_t min_capacity, size_t element_size) noexcept {
+        const size_t base_capacity = BasePolicy::NewCapacity(capacity, min_capacity, element_size);
+        const size_t bytes = growth_detail::SaturatingMul(base_capacity, element_size);
+        return growth_detail::BytesToCapacity(SizeClass(bytes), base_capacity, element_size);
+    }
+};
+
+// До порога в ThresholdBytes растёт по BasePolicy, дальше добавляет по StepBytes за раз,
+// ограничивая перерасход памяти на очень больших векторах
+template <size_t ThresholdBytes, size_t StepBytes, typename BasePolicy = DoublingGrowth>
+struct CappedLinearGrowth {
+    static_assert(StepBytes != 0, "StepBytes must be positive");
+
+    static constexpr size_t NewCapacity(size_t capacity, size_t min_capacity, size_t element_size) noexcept {
+        if (growth_detail::SaturatingMul(capacity, element_size) < ThresholdBytes) {
+            return std::min(BasePolicy::NewCapacity(capacity, min_capacity, element_size),
+                            std::max(ThresholdBytes / element_size, min_capacity));
+        }
+        const size_t step = std::max<size_t>(StepBytes / element_size, 1);
+        return std::max(growth_detail::SaturatingAdd(capacity, step), min_capacity);
+    }
+};
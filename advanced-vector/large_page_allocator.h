@@ -0,0 +1,241 @@
+#pragma once
+
+#include "vector.h"
+
+#if defined(__linux__)
+
+#define ADVANCED_VECTOR_HAS_LARGE_PAGES 1
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+inline constexpr size_t kHugePageSize = size_t(2) << 20;
+
+enum class HugePageMode {
+    kNone,
+    // madvise(MADV_HUGEPAGE): ядро собирает прозрачные большие страницы, когда может
+    kTransparent,
+    // MAP_HUGETLB из заранее выделенного пула; если пул пуст — как kTransparent
+    kExplicit,
+};
+
+// Значения совпадают с MPOL_* из <numaif.h>, который поставляется с libnuma
+enum class NumaPolicy : int {
+    kDefault = 0,
+    kPreferred = 1,
+    kBind = 2,
+    kInterleave = 3,
+};
+
+struct LargePageOptions {
+    // Выделения меньше порога обслуживает operator new
+    size_t threshold_bytes = kHugePageSize;
+    HugePageMode huge_pages = HugePageMode::kTransparent;
+    NumaPolicy numa_policy = NumaPolicy::kDefault;
+    // Бит i — узел i
+    uint64_t numa_nodes = 0;
+    // Заполнить страницы сразу при выделении, уже по заданной политике. Без этого страница попадает
+    // на узел того потока, который первым её коснётся, например потока ParallelExecution
+    bool prefault = false;
+
+    bool operator==(const LargePageOptions&) const = default;
+};
+
+namespace large_page_detail {
+
+inline size_t RoundUp(size_t bytes, size_t alignment) noexcept {
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+// Ошибки mbind и madvise не фатальны: без NUMA или THP память остаётся обычной
+inline void ApplyPlacement(void* ptr, size_t bytes, const LargePageOptions& options) noexcept {
+    if (options.huge_pages != HugePageMode::kNone) {
+        ::madvise(ptr, bytes, MADV_HUGEPAGE);
+    }
+#if defined(SYS_mbind)
+    if (options.numa_policy != NumaPolicy::kDefault && options.numa_nodes != 0) {
+        const unsigned long mask = options.numa_nodes;
+        ::syscall(SYS_mbind, ptr, bytes, static_cast<int>(options.numa_policy), &mask, sizeof(mask) * 8 + 1, 0);
+    }
+#endif
+}
+
+// Касается страниц после того, как задана политика размещения: MAP_POPULATE заполнил бы их
+// ещё до mbind
+inline void Prefault(void* ptr, size_t bytes) noexcept {
+#if defined(MADV_POPULATE_WRITE)
+    if (::madvise(ptr, bytes, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    for (size_t offset = 0; offset < bytes; offset += page_size) {
+        static_cast<volatile char*>(ptr)[offset] = 0;
+    }
+}
+
+// Анонимное отображение длиной bytes, выровненное по большой странице, или nullptr.
+// Отображаем с запасом и обрезаем края, чтобы начало попало на границу большой страницы
+inline void* MapAligned(size_t bytes, int protection) noexcept {
+    const size_t reserved = bytes + kHugePageSize;
+    void* raw = ::mmap(nullptr, reserved, protection, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    const auto raw_address = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t address = RoundUp(raw_address, kHugePageSize);
+    if (address != raw_address) {
+        ::munmap(raw, address - raw_address);
+    }
+    if (const size_t tail = raw_address + reserved - (address + bytes); tail != 0) {
+        ::munmap(reinterpret_cast<void*>(address + bytes), tail);
+    }
+    return reinterpret_cast<void*>(address);
+}
+
+// Отображение длиной bytes (кратной kHugePageSize), выровненное по большой странице
+inline void* MapLarge(size_t bytes, const LargePageOptions& options) {
+    void* ptr = MAP_FAILED;
+    if (options.huge_pages == HugePageMode::kExplicit) {
+        ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (ptr == MAP_FAILED) {
+        ptr = MapAligned(bytes, PROT_READ | PROT_WRITE);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    ApplyPlacement(ptr, bytes, options);
+    if (options.prefault) {
+        Prefault(ptr, bytes);
+    }
+    return ptr;
+}
+
+}  // namespace large_page_detail
+
+// Крупные буферы берёт из ядра отображениями, выровненными по 2 МиБ, с большими страницами
+// и заданным размещением по узлам NUMA; мелкие — из operator new. Параметры хранятся
+// в аллокаторе и переходят к каждому новому буферу, поэтому рост вектора сохраняет
+// размещение. Тривиально перемещаемые элементы растут через mremap без копирования
+template <typename T>
+class LargePageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U>
+    struct rebind {
+        using other = LargePageAllocator<U>;
+    };
+
+    LargePageAllocator() = default;
+
+    explicit LargePageAllocator(const LargePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    LargePageAllocator(const LargePageAllocator<U>& other) noexcept
+        : options_(other.GetOptions()) {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    // Крупный блок округляется до целого числа больших страниц, и вектор получает всю его ёмкость
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        if (n > kMaxSize) {
+            throw std::bad_array_new_length();
+        }
+        if (!IsLarge(n)) {
+            return {static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(alignof(T)))), n};
+        }
+        const size_t bytes = MappedBytes(n);
+        return {static_cast<T*>(large_page_detail::MapLarge(bytes, options_)), bytes / sizeof(T)};
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (IsLarge(n)) {
+            ::munmap(ptr, MappedBytes(n));
+        }
+        else {
+            operator delete(ptr, std::align_val_t(alignof(T)));
+        }
+    }
+
+    // Переносит крупный блок средствами ядра. Страницы MAP_HUGETLB так не переносятся.
+    // Блок сначала пробует вырасти на месте, а если не вышло, переезжает в заранее
+    // зарезервированный выровненный участок: mremap сам выбрал бы адрес без выравнивания
+    // по большой странице. Новый хвост получает ту же политику размещения и предзаполнение
+    T* reallocate(T* ptr, size_t old_n, size_t new_n) noexcept {
+        if (!IsLarge(old_n) || !IsLarge(new_n) || options_.huge_pages == HugePageMode::kExplicit
+            || new_n > kMaxSize) {
+            return nullptr;
+        }
+        // Длина отображения всегда вычисляется из ёмкости, поэтому deallocate(ptr, new_n) её повторит
+        const size_t old_bytes = MappedBytes(old_n);
+        const size_t new_bytes = MappedBytes(new_n);
+        void* new_ptr = ::mremap(ptr, old_bytes, new_bytes, 0);
+        if (new_ptr == MAP_FAILED) {
+            void* target = large_page_detail::MapAligned(new_bytes, PROT_NONE);
+            if (target == nullptr) {
+                return nullptr;
+            }
+            // MREMAP_FIXED заменяет резерв перенесённым отображением
+            new_ptr = ::mremap(ptr, old_bytes, new_bytes, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if (new_ptr == MAP_FAILED) {
+                ::munmap(target, new_bytes);
+                return nullptr;
+            }
+        }
+        large_page_detail::ApplyPlacement(new_ptr, new_bytes, options_);
+        if (options_.prefault && new_bytes > old_bytes) {
+            large_page_detail::Prefault(static_cast<char*>(new_ptr) + old_bytes, new_bytes - old_bytes);
+        }
+        return static_cast<T*>(new_ptr);
+    }
+
+    const LargePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    template <typename U>
+    bool operator==(const LargePageAllocator<U>& other) const noexcept {
+        return options_.threshold_bytes == other.GetOptions().threshold_bytes;
+    }
+
+    template <typename U>
+    bool operator!=(const LargePageAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    // Запас на округление до большой страницы не должен переполнять размер в байтах
+    static constexpr size_t kMaxSize = (static_cast<size_t>(-1) - kHugePageSize) / sizeof(T);
+
+    LargePageOptions options_;
+
+    bool IsLarge(size_t n) const noexcept {
+        return n * sizeof(T) >= options_.threshold_bytes;
+    }
+
+    static size_t MappedBytes(size_t n) noexcept {
+        return large_page_detail::RoundUp(n * sizeof(T), kHugePageSize);
+    }
+};
+
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+using LargePageVector = Vector<T, LargePageAllocator<T>, GrowthPolicy>;
+
+#endif
@@ -1,105 +1,335 @@
+#include "aligned_allocator.h"
+#include "buffer_pool.h"
+#include "circular_vector.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_map.h"
+#include "large_page_allocator.h"
+#include "malloc_allocator.h"
+#include "mapped_vector.h"
+#include "segmented_vector.h"
+#include "serialization.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "static_vector.h"
+#include "test_objects.h"
 #include "vector.h"
+#include "vector_trace.h"
 
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <map>
+#include <numeric>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 
 namespace {
 
-// "Магическое" число, используемое для отслеживания живости объекта
-inline const uint32_t DEFAULT_COOKIE = 0xdeadbeef;
+// Аллокатор с состоянием: считает выделения в общем для всех копий счётчике
+template <typename T, bool Propagate = false>
+struct TrackingAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_swap = std::bool_constant<Propagate>;
 
-struct TestObj {
-    TestObj() = default;
-    TestObj(const TestObj& other) = default;
-    TestObj& operator=(const TestObj& other) = default;
-    TestObj(TestObj&& other) = default;
-    TestObj& operator=(TestObj&& other) = default;
-    ~TestObj() {
-        cookie = 0;
+    struct Counters {
+        int allocations = 0;
+        int deallocations = 0;
+    };
+
+    explicit TrackingAllocator(Counters* counters)
+        : counters(counters)  //
+    {
     }
-    [[nodiscard]] bool IsAlive() const noexcept {
-        return cookie == DEFAULT_COOKIE;
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, Propagate>& other) noexcept
+        : counters(reinterpret_cast<Counters*>(other.counters))  //
+    {
     }
-    uint32_t cookie = DEFAULT_COOKIE;
-};
 
-struct Obj {
-    Obj() {
-        if (default_construction_throw_countdown > 0) {
-            if (--default_construction_throw_countdown == 0) {
-                throw std::runtime_error("Oops");
-            }
-        }
-        ++num_default_constructed;
+    T* allocate(size_t n) {
+        ++counters->allocations;
+        return static_cast<T*>(operator new(n * sizeof(T)));
     }
 
-    explicit Obj(int id)
-        : id(id)  //
+    void deallocate(T* p, size_t) noexcept {
+        ++counters->deallocations;
+        operator delete(p);
+    }
+
+    bool operator==(const TrackingAllocator& other) const noexcept {
+        return counters == other.counters;
+    }
+
+    bool operator!=(const TrackingAllocator& other) const noexcept {
+        return !(*this == other);
+    }
+
+    Counters* counters;
+};
+
+// Владеющая обёртка: не тривиально копируема, но её можно переносить побайтово
+struct RelocatableObj {
+    explicit RelocatableObj(int id)
+        : id(std::make_unique<int>(id))  //
     {
-        ++num_constructed_with_id;
     }
 
-    Obj(int id, std::string name)
-        : id(id)
-        , name(std::move(name))  //
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : id(std::move(other.id))  //
     {
-        ++num_constructed_with_id_and_name;
+        ++num_moved;
+    }
+
+    RelocatableObj& operator=(RelocatableObj&& other) noexcept {
+        id = std::move(other.id);
+        ++num_moved;
+        return *this;
     }
 
-    Obj(const Obj& other)
-        : id(other.id)  //
+    std::unique_ptr<int> id;
+
+    static inline int num_moved = 0;
+};
+
+// Линейный аллокатор поверх общего буфера: умеет расширять последний выделенный блок
+// на месте и округляет каждый запрос до кратного 8 числа элементов
+template <typename T>
+struct BumpAllocator {
+    using value_type = T;
+
+    struct Arena {
+        alignas(std::max_align_t) char buffer[1 << 16];
+        size_t top = 0;
+    };
+
+    explicit BumpAllocator(Arena* arena)
+        : arena(arena)  //
     {
-        if (other.throw_on_copy) {
-            throw std::runtime_error("Oops");
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const size_t count = (n + 7) / 8 * 8;
+        return {allocate(count), count};
+    }
+
+    T* allocate(size_t n) {
+        const size_t offset = (arena->top + alignof(T) - 1) / alignof(T) * alignof(T);
+        if (offset + n * sizeof(T) > sizeof(arena->buffer)) {
+            throw std::bad_alloc();
         }
-        ++num_copied;
+        arena->top = offset + n * sizeof(T);
+        return reinterpret_cast<T*>(arena->buffer + offset);
     }
 
-    Obj(Obj&& other) noexcept
-        : id(other.id)  //
-    {
-        ++num_moved;
+    bool try_expand(T* p, size_t old_n, size_t new_n) noexcept {
+        char* block_end = reinterpret_cast<char*>(p + old_n);
+        if (block_end != arena->buffer + arena->top
+            || reinterpret_cast<char*>(p + new_n) > arena->buffer + sizeof(arena->buffer)) {
+            return false;
+        }
+        arena->top = reinterpret_cast<char*>(p + new_n) - arena->buffer;
+        return true;
+    }
+
+    void deallocate(T*, size_t) noexcept {
+    }
+
+    bool operator==(const BumpAllocator& other) const noexcept {
+        return arena == other.arena;
+    }
+
+    bool operator!=(const BumpAllocator& other) const noexcept {
+        return !(*this == other);
+    }
+
+    Arena* arena;
+};
+
+// Счётчики атомарны: объекты создаются и разрушаются из разных потоков
+struct SharedCountedObj {
+    SharedCountedObj()
+        : SharedCountedObj(0) {
     }
 
-    Obj& operator=(const Obj& other) = default;
-    Obj& operator=(Obj&& other) = default;
+    explicit SharedCountedObj(int id)
+        : id(id) {
+        if (construction_throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
 
-    ~Obj() {
-        ++num_destroyed;
-        id = 0;
+    SharedCountedObj(const SharedCountedObj& other)
+        : SharedCountedObj(other.id) {
     }
 
-    static int GetAliveObjectCount() {
-        return num_default_constructed + num_copied + num_moved + num_constructed_with_id
-            + num_constructed_with_id_and_name - num_destroyed;
+    SharedCountedObj(SharedCountedObj&& other) noexcept
+        : id(other.id) {
+        ++alive;
     }
 
-    static void ResetCounters() {
-        default_construction_throw_countdown = 0;
-        num_default_constructed = 0;
-        num_copied = 0;
-        num_moved = 0;
-        num_destroyed = 0;
-        num_constructed_with_id = 0;
-        num_constructed_with_id_and_name = 0;
+    SharedCountedObj& operator=(const SharedCountedObj&) = default;
+
+    ~SharedCountedObj() {
+        --alive;
     }
 
-    bool throw_on_copy = false;
     int id = 0;
+
+    static inline std::atomic<int> alive = 0;
+    // Конструктор, уменьшивший счётчик с 1 до 0, выбрасывает исключение
+    static inline std::atomic<int> construction_throw_countdown = 0;
+};
+
+// Конструктор перемещения не объявлен, поэтому перенос идёт через бросающее копирование
+struct CopyOnly {
+    explicit CopyOnly(int value)
+        : value(value) {
+    }
+
+    CopyOnly(const CopyOnly& other)
+        : value(other.value) {
+        if (value == throw_on_copy_of) {
+            throw std::runtime_error("Oops");
+        }
+    }
+
+    CopyOnly& operator=(const CopyOnly&) = default;
+
+    int value;
+
+    static inline int throw_on_copy_of = -1;
+};
+
+// Некопируемый тип с перемещением без noexcept
+struct MoveOnlyThrowing {
+    explicit MoveOnlyThrowing(int value)
+        : value(value) {
+    }
+
+    MoveOnlyThrowing(const MoveOnlyThrowing&) = delete;
+
+    MoveOnlyThrowing(MoveOnlyThrowing&& other) noexcept(false)
+        : value(other.value) {
+        if (value == throw_on_move_of) {
+            throw std::runtime_error("Oops");
+        }
+    }
+
+    MoveOnlyThrowing& operator=(MoveOnlyThrowing&&) = default;
+
+    int value;
+
+    static inline int throw_on_move_of = -1;
+};
+
+// Запись с перемещением без noexcept, как у std::string на некоторых стандартных библиотеках
+template <bool kAllowMove>
+struct ThrowingMoveRecord {
+    explicit ThrowingMoveRecord(std::string name)
+        : name(std::move(name)) {
+    }
+
+    ThrowingMoveRecord(const ThrowingMoveRecord& other)
+        : name(other.name) {
+        ++num_copied;
+    }
+
+    ThrowingMoveRecord(ThrowingMoveRecord&& other) noexcept(false)
+        : name(std::move(other.name)) {
+        if (!throw_on_move_of.empty() && name == throw_on_move_of) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_moved;
+    }
+
+    ThrowingMoveRecord& operator=(const ThrowingMoveRecord&) = default;
+    ThrowingMoveRecord& operator=(ThrowingMoveRecord&&) = default;
+
     std::string name;
 
-    static inline int default_construction_throw_countdown = 0;
-    static inline int num_default_constructed = 0;
-    static inline int num_constructed_with_id = 0;
-    static inline int num_constructed_with_id_and_name = 0;
     static inline int num_copied = 0;
     static inline int num_moved = 0;
-    static inline int num_destroyed = 0;
+    static inline std::string throw_on_move_of;
 };
 
+// Таблица квадратов, собранная при компиляции: промежуточный Vector живёт только
+// во время вычисления, результат переносится в StaticVector
+constexpr StaticVector<int, 16> MakeSquares() {
+    Vector<int> squares;
+    for (int i = 0; i < 20; ++i) {
+        squares.PushBack(i * i);
+    }
+    squares.Erase(squares.begin() + 16, squares.end());
+    StaticVector<int, 16> table;
+    for (int square : squares) {
+        table.PushBack(square);
+    }
+    return table;
+}
+
+constexpr bool CheckConstexprVector() {
+    Vector<int> v{1, 2, 3};
+    v.Insert(v.begin(), 0);
+    v.Emplace(v.begin() + 2, 10);
+    v.Reserve(100);
+    v.Resize(8);
+    v.ShrinkToFit();
+    Vector<int> copy = v;
+    copy.Assign({5, 6});
+    Vector<int> moved(std::move(copy));
+    copy = v;
+    Vector<std::string> words;
+    for (int i = 0; i < 10; ++i) {
+        words.EmplaceBack(static_cast<size_t>(i + 1), 'a');
+    }
+    words.Erase(words.begin());
+    words.Insert(words.begin() + 3, std::string("b"));
+    return v.Size() == 8 && v[2] == 10 && v[7] == 0 && copy == v && v < moved && moved.Size() == 2
+        && words.Size() == 10 && words[0] == "aa" && words[3] == "b" && words[9].size() == 10;
+}
+
+constexpr bool CheckConstexprStaticVector() {
+    StaticVector<std::string, 8> v{"b", "d"};
+    v.Insert(v.begin(), "a");
+    v.Emplace(v.begin() + 2, 1, 'c');
+    StaticVector<std::string, 8> copy = v;
+    v.Erase(v.begin() + 1);
+    copy = v;
+    StaticVector<std::string, 8> moved(std::move(copy));
+    moved.PopBack();
+    return v.Size() == 3 && v[1] == "c" && moved.Size() == 2 && moved[1] == "c";
+}
+
+template <typename V>
+concept CanReleaseStorage = requires(V& v) { v.ReleaseStorage(); };
+
+template <typename V>
+concept CanRelease = requires(V& v) { v.Release(); };
+
 }  // namespace
 
+template <>
+struct RelocateByMove<ThrowingMoveRecord<true>> : std::true_type {
+};
+
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {
+};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -380,6 +610,2025 @@ void Test5() {
     }
 }
 
+void Test6() {
+    const size_t SIZE = 100;
+    const int ID = 42;
+    using Alloc = TrackingAllocator<Obj>;
+    using PropagatingAlloc = TrackingAllocator<Obj, true>;
+    Alloc::Counters first_counters;
+    Alloc::Counters second_counters;
+    {
+        Obj::ResetCounters();
+        Vector<Obj, Alloc> v(SIZE, Alloc(&first_counters));
+        assert(first_counters.allocations == 1);
+        v.PushBack(Obj{ID});
+        assert(first_counters.allocations == 2);
+        assert(first_counters.deallocations == 1);
+        assert(v.GetAllocator() == Alloc(&first_counters));
+
+        // Копия получает аллокатор оригинала (select_on_container_copy_construction)
+        Vector<Obj, Alloc> v_copy(v);
+        assert(first_counters.allocations == 3);
+        assert(v_copy[SIZE].id == ID);
+
+        // Без распространения аллокатора перемещение между разными аллокаторами поэлементное
+        Vector<Obj, Alloc> other(Alloc{&second_counters});
+        const int old_move_count = Obj::num_moved;
+        other = std::move(v);
+        assert(other.GetAllocator() == Alloc(&second_counters));
+        assert(second_counters.allocations == 1);
+        assert(Obj::num_moved - old_move_count == static_cast<int>(SIZE + 1));
+        assert(other[SIZE].id == ID);
+
+        // С равными аллокаторами перемещение забирает буфер
+        const Obj* data = &v_copy[0];
+        Vector<Obj, Alloc> same(Alloc{&first_counters});
+        same = std::move(v_copy);
+        assert(&same[0] == data);
+        assert(v_copy.Size() == 0);
+    }
+    assert(first_counters.allocations == first_counters.deallocations);
+    assert(second_counters.allocations == second_counters.deallocations);
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        PropagatingAlloc::Counters a_counters;
+        PropagatingAlloc::Counters b_counters;
+        Vector<Obj, PropagatingAlloc> a(SIZE, PropagatingAlloc(&a_counters));
+        Vector<Obj, PropagatingAlloc> b(SIZE / 2, PropagatingAlloc(&b_counters));
+        const Obj* a_data = &a[0];
+
+        // Swap и перемещение с распространением аллокатора выполняются за O(1)
+        a.Swap(b);
+        assert(&b[0] == a_data);
+        assert(b.GetAllocator() == PropagatingAlloc(&a_counters));
+        b = std::move(a);
+        assert(b.GetAllocator() == PropagatingAlloc(&b_counters));
+        assert(b.Size() == SIZE / 2);
+
+        a = b;
+        assert(a.GetAllocator() == PropagatingAlloc(&b_counters));
+        assert(a.Size() == SIZE / 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test7() {
+    const int SIZE = 100;
+    static_assert(IsTriviallyRelocatableV<int>);
+    static_assert(!IsTriviallyRelocatableV<Obj>);
+    static_assert(IsTriviallyRelocatableV<RelocatableObj>);
+    {
+        RelocatableObj::num_moved = 0;
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(SIZE * 4);
+        // Рост, вставка в середину и удаление не вызывают конструкторы перемещения элементов
+        v.Emplace(v.begin() + SIZE / 2, -1);
+        v.Erase(v.begin());
+        v.Emplace(v.begin(), -2);
+        assert(RelocatableObj::num_moved == 2);
+        assert(v.Size() == SIZE + 1);
+        assert(*v[0].id == -2);
+        assert(*v[1].id == 1);
+        assert(*v[SIZE / 2].id == -1);
+        assert(*v[SIZE].id == SIZE - 1);
+    }
+    {
+        Vector<int> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.Insert(v.begin(), i);
+        }
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == SIZE - 1);
+        assert(v[0] == SIZE - 1);
+        assert(v[1] == SIZE - 3);
+        assert(v[SIZE - 2] == 0);
+    }
+}
+
+void Test8() {
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 13);
+        v.Resize(100);
+        assert(v.Capacity() == 100);
+        v.Resize(101);
+        assert(v.Capacity() == 150);
+    }
+    {
+        Vector<char, std::allocator<char>, PageRoundedGrowth<>> v;
+        v.Resize(5000);
+        assert(v.Capacity() == 8192);
+        v.Resize(10);
+        v.Resize(100);
+        assert(v.Capacity() == 8192);
+    }
+    {
+        Vector<int, std::allocator<int>, SizeClassGrowth<>> v;
+        v.Resize(25);
+        // 100 байт округляются до класса 112 байт
+        assert(v.Capacity() == 28);
+    }
+    {
+        using LinearGrowth = CappedLinearGrowth<1024, 256>;
+        Vector<int, std::allocator<int>, LinearGrowth> v;
+        for (int i = 0; i < 300; ++i) {
+            v.PushBack(i);
+        }
+        // 256 элементов по 4 байта достигают порога, дальше шаг 64 элемента
+        assert(v.Capacity() == 320);
+        assert(v[299] == 299);
+    }
+}
+
+void Test9() {
+    const int SIZE = 1000;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        v.PushBack(v[0]);
+        v.Reserve(SIZE * 10);
+        assert(v.Capacity() == SIZE * 10);
+        assert(v.Size() == SIZE + 1);
+        assert(v[SIZE - 1] == SIZE - 1);
+        assert(v[SIZE] == 0);
+    }
+    {
+        using Alloc = BumpAllocator<Obj>;
+        Alloc::Arena arena;
+        Obj::ResetCounters();
+        Vector<Obj, Alloc> v(Alloc{&arena});
+        v.Reserve(3);
+        // allocate_at_least возвращает больше запрошенного
+        assert(v.Capacity() == 8);
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.EmplaceBack(v[0]);
+        v.Reserve(500);
+        // Блок всегда расширялся на месте, поэтому элементы ни разу не перемещались
+        assert(Obj::num_moved == 0);
+        assert(v.Capacity() == 500);
+        assert(v.Size() == 101);
+        assert(v[99].id == 99);
+        assert(v[100].id == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test10() {
+    const int ID = 42;
+    const size_t N = 4;
+    using SmallObjVector = SmallVector<Obj, N>;
+    auto is_inside = [](const auto& v) {
+        const auto* object = reinterpret_cast<const char*>(&v);
+        const auto* data = reinterpret_cast<const char*>(v.begin());
+        return data >= object && data < object + sizeof(v);
+    };
+    {
+        Obj::ResetCounters();
+        SmallObjVector v;
+        assert(v.Capacity() == N);
+        assert(v.IsSmall());
+        for (size_t i = 0; i < N; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(is_inside(v));
+        v.Emplace(v.begin(), ID);
+        assert(!v.IsSmall());
+        assert(v.Capacity() == N * 2);
+        assert(v[0].id == ID);
+        assert(v[N].id == static_cast<int>(N - 1));
+
+        // Буфер из кучи забирается без перемещения элементов, источник снова маленький
+        const int old_move_count = Obj::num_moved;
+        const Obj* data = v.begin();
+        SmallObjVector moved(std::move(v));
+        assert(moved.begin() == data);
+        assert(Obj::num_moved == old_move_count);
+        assert(v.IsSmall() && v.Size() == 0);
+
+        SmallObjVector small;
+        small.EmplaceBack(ID);
+        SmallObjVector copy(small);
+        assert(copy.IsSmall() && copy.Size() == 1 && copy[0].id == ID);
+
+        small.Swap(moved);
+        assert(!small.IsSmall() && small.Size() == N + 1);
+        assert(moved.IsSmall() && moved.Size() == 1 && moved[0].id == ID);
+
+        moved = std::move(small);
+        assert(!moved.IsSmall() && moved.Size() == N + 1);
+        assert(small.IsSmall());
+
+        copy = moved;
+        assert(copy.Size() == N + 1 && copy[0].id == ID);
+        copy.Erase(copy.begin());
+        assert(copy[0].id == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<int, N> v(N / 2);
+        assert(v.IsSmall() && v.Size() == N / 2 && v[0] == 0);
+        SmallVector<int, N> init{1, 2, 3};
+        assert(init.IsSmall() && init.Size() == 3 && init[2] == 3);
+        SmallVector<int, N> large(N * 4);
+        assert(!large.IsSmall() && large.Capacity() == N * 4);
+    }
+}
+
+void Test11() {
+    using namespace std::literals;
+    {
+        Vector<std::string> v{"a"s, "b"s, "c"s};
+        assert(v.Size() == 3 && v.Capacity() == 3);
+        const std::string extra[] = {"x"s, "y"s, "z"s, "w"s};
+        // Вставка растит буфер один раз
+        v.Insert(v.begin() + 1, std::begin(extra), std::end(extra));
+        assert(v.Size() == 7 && v.Capacity() == 7);
+        assert(v[0] == "a"s && v[1] == "x"s && v[4] == "w"s && v[5] == "b"s && v[6] == "c"s);
+
+        v.Reserve(20);
+        v.Insert(v.begin() + 5, {"p"s, "q"s});
+        v.Insert(v.begin() + 1, 3, v[0]);
+        assert(v.Size() == 12);
+        assert(v[1] == "a"s && v[3] == "a"s && v[4] == "x"s && v[8] == "p"s && v[11] == "c"s);
+
+        std::list<std::string> tail{"t1"s, "t2"s};
+        v.Append(tail);
+        assert(v.Size() == 14 && v[13] == "t2"s);
+
+        v.Assign({"only"s});
+        assert(v.Size() == 1 && v[0] == "only"s);
+        v.Assign(4, "four"s);
+        assert(v.Size() == 4 && v[3] == "four"s);
+    }
+    {
+        Vector<int> v = {1, 2, 3};
+        const int numbers[] = {4, 5, 6, 7, 8};
+        v.Append(numbers);
+        assert(v.Size() == 8 && v.Capacity() == 8);
+        v.Insert(v.begin(), v.Size(), 0);
+        assert(v.Size() == 16 && v[7] == 0 && v[8] == 1 && v[15] == 8);
+
+        std::istringstream input("9 10 11");
+        v.Insert(v.begin() + 8, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == 19 && v[8] == 9 && v[10] == 11 && v[11] == 1);
+
+        std::istringstream assign_input("1 2");
+        v.Assign(std::istream_iterator<int>(assign_input), std::istream_iterator<int>());
+        assert(v.Size() == 2 && v[1] == 2);
+
+        Vector<int> from_range(std::begin(numbers), std::end(numbers));
+        assert(from_range.Size() == 5 && from_range[4] == 8);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(4);
+        Vector<Obj> source(6);
+        source[5].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 2, source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        // При переезде в новый буфер действует строгая гарантия
+        assert(v.Size() == 4 && v.Capacity() == 4);
+        assert(Obj::GetAliveObjectCount() == 10);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test12() {
+    const int SIZE = 100;
+    {
+        Vector<int> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(i);
+        }
+        auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(*it == 20 && v.Size() == SIZE - 10);
+        assert(v.Erase(v.begin(), v.begin()) == v.begin());
+        const size_t removed = v.EraseIf([](int x) {
+            return x % 3 == 0;
+        });
+        assert(removed == 31);
+        assert(v.Size() == SIZE - 41);
+        assert(v[0] == 1 && v[1] == 2 && v[2] == 4 && v[v.Size() - 1] == 98);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        const int old_destroyed_count = Obj::num_destroyed;
+        v.Erase(v.end() - 10, v.end());
+        assert(Obj::num_destroyed - old_destroyed_count == 10);
+        const size_t removed = v.EraseIf([](const Obj& obj) {
+            return obj.id % 2 == 1;
+        });
+        assert(removed == (SIZE - 10) / 2);
+        assert(v.Size() == (SIZE - 10) / 2);
+        assert(v[1].id == 2 && v[v.Size() - 1].id == SIZE - 12);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size()));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v = {1, 2, 3, 4, 5, 6};
+        try {
+            v.EraseIf([](int x) {
+                if (x == 5) {
+                    throw std::runtime_error("Oops");
+                }
+                return x % 2 == 0;
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        // Уже проверенные элементы уплотнены, остальные сохранены
+        assert(v.Size() == 4);
+        assert(v[0] == 1 && v[1] == 3 && v[2] == 5 && v[3] == 6);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 1000;
+    {
+        Vector<char> buffer(SIZE, kDefaultInit);
+        assert(buffer.Size() == SIZE);
+        buffer.ResizeDefaultInit(SIZE * 4);
+        assert(buffer.Size() == SIZE * 4);
+        buffer.ResizeDefaultInit(10);
+        assert(buffer.Size() == 10 && buffer.Capacity() == SIZE * 4);
+    }
+    {
+        Vector<char> buffer;
+        const char* message = "hello";
+        buffer.ResizeAndOverwrite(64, [message](char* data, size_t capacity) {
+            const size_t length = std::strlen(message);
+            assert(capacity >= length);
+            std::memcpy(data, message, length);
+            return length;
+        });
+        assert(buffer.Size() == 5 && buffer.Capacity() == 64);
+        assert(std::memcmp(buffer.begin(), message, 5) == 0);
+        try {
+            buffer.ResizeAndOverwrite(128, [](char*, size_t) -> size_t {
+                throw std::runtime_error("Oops");
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(buffer.Size() == 5 && buffer[4] == 'o');
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.ResizeAndOverwrite(SIZE, [](Obj* data, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                data[i].id = static_cast<int>(i);
+            }
+            return count / 2;
+        });
+        assert(v.Size() == SIZE / 2);
+        assert(v[SIZE / 2 - 1].id == static_cast<int>(SIZE / 2 - 1));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 4);
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == SIZE * 4);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        v.Resize(SIZE / 2);
+        v[0].id = 42;
+        v.ShrinkToFit();
+        assert(v.Size() == SIZE / 2 && v.Capacity() == SIZE / 2);
+        assert(v[0].id == 42);
+
+        auto storage = v.ReleaseStorage();
+        assert(storage.Capacity() == SIZE / 2);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        v.Resize(1);
+        v.Resize(0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    {
+        // После сжатия маленький вектор возвращается во встроенный буфер
+        SmallVector<int, 4> v(SIZE);
+        assert(!v.IsSmall());
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.IsSmall() && v.Size() == 3);
+        // Встроенный буфер нельзя отдать наружу
+        static_assert(CanReleaseStorage<Vector<int>> && !CanReleaseStorage<SmallVector<int, 4>>);
+        static_assert(CanRelease<Vector<int>> && !CanRelease<SmallVector<int, 4>>);
+    }
+}
+
+void Test15() {
+    struct alignas(128) Lane {
+        float values[32] = {};
+    };
+    auto is_aligned = [](const void* ptr, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+    };
+    {
+        Vector<Lane> v(3);
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(Lane{});
+            assert(is_aligned(v.begin(), alignof(Lane)));
+        }
+        SmallVector<Lane, 2> small;
+        assert(is_aligned(small.begin(), alignof(Lane)));
+    }
+    {
+        AlignedVector<char, kPageSize> io_buffer(100);
+        assert(is_aligned(io_buffer.begin(), kPageSize));
+        io_buffer.Resize(kPageSize * 3);
+        assert(is_aligned(io_buffer.begin(), kPageSize));
+        io_buffer.ShrinkToFit();
+        assert(is_aligned(io_buffer.begin(), kPageSize));
+
+        AlignedVector<float, kCacheLineSize> simd_buffer;
+        simd_buffer.Append({1.0f, 2.0f, 3.0f});
+        assert(is_aligned(simd_buffer.begin(), kCacheLineSize));
+        assert(simd_buffer[2] == 3.0f);
+    }
+}
+
+void Test16() {
+    const size_t SIZE = 100;
+    static_assert(sizeof(Vector<int>) == sizeof(Vector<int, std::allocator<int>, DoublingGrowth, NoVectorStats>));
+    {
+        Obj::ResetCounters();
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth, PerInstanceVectorStats> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        const VectorStats& stats = v.GetStats().Get();
+        // Вместимость 1, 2, 4, ..., 128: восемь выделений и семь переездов
+        assert(stats.allocations == 8);
+        assert(stats.reallocations == 7);
+        assert(stats.bytes_allocated == 255 * sizeof(Obj));
+        assert(stats.peak_capacity == 128);
+        assert(stats.elements_moved == 127);
+        assert(stats.elements_copied == 0);
+
+        auto copy = v;
+        assert(copy.GetStats().Get().allocations == 1);
+        v.ShrinkToFit();
+        assert(v.GetStats().Get().reallocations == 8);
+    }
+    {
+        // Конструктор перемещения без noexcept вынуждает копировать элементы при росте
+        struct ThrowingMove {
+            ThrowingMove() = default;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&&) {
+            }
+            ThrowingMove& operator=(const ThrowingMove&) = default;
+            ThrowingMove& operator=(ThrowingMove&&) = default;
+        };
+        using Stats = PerTypeVectorStats<ThrowingMove>;
+        Stats::Reset();
+        Vector<ThrowingMove, std::allocator<ThrowingMove>, DoublingGrowth, Stats> a(SIZE);
+        Vector<ThrowingMove, std::allocator<ThrowingMove>, DoublingGrowth, Stats> b(SIZE);
+        a.Reserve(SIZE * 2);
+        b.EmplaceBack();
+        assert(Stats::Get().allocations == 4);
+        assert(Stats::Get().elements_copied == SIZE * 2);
+        assert(Stats::Get().elements_moved == 0);
+    }
+    {
+        Vector<int, MallocAllocator<int>, DoublingGrowth, PerInstanceVectorStats> v;
+        v.Reserve(SIZE);
+        v.Resize(SIZE);
+        v.Reserve(SIZE * 100);
+        assert(v.GetStats().Get().allocations == 1);
+        assert(v.GetStats().Get().in_place_growths + v.GetStats().Get().reallocations == 1);
+        assert(v.GetStats().Get().peak_capacity == SIZE * 100);
+    }
+}
+
+void Test17() {
+    const size_t CHUNK = 8;
+    const size_t SIZE = CHUNK * 4 + 3;
+    using SegmentedObjVector = SegmentedVector<Obj, CHUNK>;
+    static_assert(SegmentedVector<int>::kChunkSize == 1024);
+    {
+        Obj::ResetCounters();
+        SegmentedObjVector v;
+        v.EmplaceBack(0);
+        const Obj* first = &v[0];
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.PushBack(Obj(static_cast<int>(i)));
+        }
+        // Рост добавляет блоки, не перемещая уже созданные элементы
+        assert(&v[0] == first);
+        assert(Obj::num_moved == static_cast<int>(SIZE - 1));
+        assert(v.Size() == SIZE);
+        assert(v.ChunkCount() == 5);
+        assert(v.Capacity() == CHUNK * 5);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+
+        auto it = v.begin() + 1;
+        v.EmplaceBack(static_cast<int>(SIZE));
+        assert(it->id == 1);
+        assert(v.end() - v.begin() == static_cast<std::ptrdiff_t>(SIZE + 1));
+        assert(std::is_sorted(v.begin(), v.end(), [](const Obj& lhs, const Obj& rhs) {
+            return lhs.id < rhs.id;
+        }));
+        const auto& const_v = v;
+        SegmentedObjVector::const_iterator const_it = v.begin();
+        assert(const_it == const_v.begin() && const_it[CHUNK].id == static_cast<int>(CHUNK));
+
+        SegmentedObjVector copy(v);
+        assert(copy.Size() == v.Size() && copy[SIZE].id == static_cast<int>(SIZE));
+        SegmentedObjVector moved(std::move(v));
+        assert(&moved[0] == first && v.Size() == 0);
+
+        moved.Resize(CHUNK + 1);
+        assert(moved.Size() == CHUNK + 1 && moved.ChunkCount() == 5);
+        moved.ShrinkToFit();
+        assert(moved.ChunkCount() == 2 && &moved[0] == first);
+        moved.Clear();
+        copy = moved;
+        assert(copy.Size() == 0);
+    }
+    assert(Obj::num_default_constructed + Obj::num_constructed_with_id + Obj::num_copied + Obj::num_moved
+           == Obj::GetAliveObjectCount() + Obj::num_destroyed);
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SegmentedVector<std::string, 2> v{"a", "b", "c"};
+        v.Reserve(10);
+        assert(v.ChunkCount() == 5);
+        v.PopBack();
+        assert(v.Size() == 2 && v[1] == "b");
+    }
+}
+
+void Test18() {
+    const size_t THREADS = 4;
+    const size_t PER_THREAD = 10000;
+    const size_t BATCH = 100;
+    {
+        ConcurrentVector<std::pair<size_t, size_t>> v;
+        v.EmplaceBack(THREADS, 0);
+        const auto* first = &v[0];
+        Vector<std::thread> threads;
+        for (size_t t = 0; t < THREADS; ++t) {
+            threads.EmplaceBack([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    const size_t index = v.EmplaceBack(t, i);
+                    assert(v[index].first == t && v[index].second == i);
+                }
+                const size_t batch = v.GrowBy(BATCH);
+                for (size_t i = 0; i < BATCH; ++i) {
+                    v[batch + i] = {t, PER_THREAD + i};
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        // Рост не перемещает опубликованные элементы
+        assert(&v[0] == first);
+        assert(v.Size() == THREADS * (PER_THREAD + BATCH) + 1);
+        assert(v.Capacity() >= v.Size());
+
+        // Элементы каждого потока идут в порядке добавления
+        Vector<size_t> next(THREADS + 1);
+        for (size_t i = 1; i < v.Size(); ++i) {
+            const auto [t, value] = v[i];
+            assert(t < THREADS && value == next[t]);
+            ++next[t];
+        }
+    }
+    {
+        Obj::ResetCounters();
+        {
+            ConcurrentVector<Obj> v;
+            v.Reserve(100);
+            assert(v.Capacity() >= 100);
+            v.EmplaceBack(1);
+            Obj::default_construction_throw_countdown = 3;
+            try {
+                v.GrowBy(10);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(Obj::GetAliveObjectCount() == 1);
+            v.GrowBy(2);
+            v.PushBack(Obj(2));
+            assert(v.Size() == 14);
+            assert(v[13].id == 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test19() {
+    const size_t SIZE = 10000;
+    const ParallelExecution policy{4, 100};
+    assert(policy.ThreadCount(SIZE) == 4);
+    assert(policy.ThreadCount(150) == 1);
+    {
+        Vector<SharedCountedObj> v(SIZE, policy);
+        assert(v.Size() == SIZE && SharedCountedObj::alive == static_cast<int>(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+
+        Vector<SharedCountedObj> copy(v, policy);
+        assert(copy.Size() == SIZE && SharedCountedObj::alive == static_cast<int>(SIZE * 2));
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(copy[i].id == static_cast<int>(i));
+        }
+
+        const SharedCountedObj* data = copy.begin();
+        copy.Reserve(SIZE * 2, policy);
+        assert(copy.begin() != data && copy.Capacity() == SIZE * 2);
+        assert(copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        assert(SharedCountedObj::alive == static_cast<int>(SIZE * 2));
+
+        copy.Clear(policy);
+        assert(copy.Size() == 0 && SharedCountedObj::alive == static_cast<int>(SIZE));
+
+        // Исключение в одном из потоков откатывает и работу остальных
+        SharedCountedObj::construction_throw_countdown = static_cast<int>(SIZE / 2);
+        try {
+            Vector<SharedCountedObj> failed(v, policy);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        SharedCountedObj::construction_throw_countdown = static_cast<int>(SIZE - 1);
+        try {
+            Vector<SharedCountedObj> failed(SIZE, policy);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        SharedCountedObj::construction_throw_countdown = 0;
+        assert(SharedCountedObj::alive == static_cast<int>(SIZE));
+    }
+    assert(SharedCountedObj::alive == 0);
+    {
+        Vector<int> v(SIZE, policy);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+        Vector<int> copy(v, policy);
+        copy.Reserve(SIZE * 3, policy);
+        assert(std::equal(v.begin(), v.end(), copy.begin(), copy.begin() + SIZE));
+    }
+}
+
+#ifdef ADVANCED_VECTOR_HAS_MMAP
+void Test20() {
+    struct Record {
+        int id;
+        double value;
+    };
+    const size_t SIZE = 1000;
+    const std::string path = (std::filesystem::temp_directory_path() / "advanced_vector_test20.bin").string();
+    std::filesystem::remove(path);
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == 0 && !v.IsFileBacked());
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(Record{static_cast<int>(i), i * 0.5});
+        }
+        assert(v.IsFileBacked());
+    }
+    {
+        // Файл открывается без чтения элементов, рост продолжается в нём же
+        MappedVector<Record> v(path);
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE && v.IsFileBacked());
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i) && v[i].value == i * 0.5);
+        }
+        v.Reserve(SIZE * 4);
+        assert(v.IsFileBacked() && v.Capacity() == SIZE * 4);
+        v.PushBack(Record{-1, 0.0});
+        v.ShrinkToFit();
+        assert(v.IsFileBacked() && v.Capacity() == SIZE + 1);
+        v.Flush();
+
+        Vector<Record, MappedFileAllocator<Record>> copy(v);
+        assert(!copy.GetAllocator().IsMapped(copy.begin()) && copy[SIZE].id == -1);
+    }
+    assert(std::filesystem::file_size(path) > (SIZE + 1) * sizeof(Record));
+    {
+        // Изменения в режиме копирования при записи не попадают в файл
+        MappedVector<Record> v(path, MapMode::kPrivate);
+        assert(v.Size() == SIZE + 1 && v.IsFileBacked());
+        v[0].id = 42;
+        v.Reserve(SIZE * 2);
+        assert(!v.IsFileBacked() && v[0].id == 42 && v[SIZE].id == -1);
+    }
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == SIZE + 1 && v[0].id == 0);
+        v.Clear();
+    }
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == 0);
+        try {
+            MappedVector<int> wrong(path);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+    }
+    {
+        // Присваивание большего числа элементов растит тот же файл, а не выделяет новый буфер
+        MappedVector<Record> v(path);
+        for (size_t i = 0; i < 10; ++i) {
+            v.PushBack(Record{static_cast<int>(i), 0.0});
+        }
+        Vector<Record> records(SIZE);
+        records[SIZE - 1].id = 7;
+        v.Assign(records.begin(), records.end());
+        assert(v.IsFileBacked() && v.Size() == SIZE && v[SIZE - 1].id == 7);
+        v.Assign(SIZE * 2, Record{3, 1.5});
+        assert(v.IsFileBacked() && v.Size() == SIZE * 2 && v[SIZE].id == 3);
+    }
+    {
+        // Очистка с освобождением файла сохраняет в заголовке новый размер
+        MappedVector<Record> v(path);
+        assert(v.Size() == SIZE * 2 && v[SIZE * 2 - 1].id == 3);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(!v.IsFileBacked() && v.Capacity() == 0);
+    }
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == 0);
+        v.PushBack(Record{1, 1.0});
+        v.Flush();
+        (void)v.ReleaseStorage();
+        assert(!v.IsFileBacked());
+    }
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == 0);
+    }
+    std::filesystem::remove(path);
+}
+#endif
+
+void Test21() {
+    struct Record {
+        int id;
+        float value;
+    };
+    const size_t SIZE = 1000;
+    Vector<Record> v;
+    for (size_t i = 0; i < SIZE; ++i) {
+        v.PushBack(Record{static_cast<int>(i), static_cast<float>(i) / 2});
+    }
+    assert(v.AsBytes().size() == SIZE * sizeof(Record));
+    assert(v.AsBytes().data() == reinterpret_cast<const std::byte*>(v.begin()));
+    auto same = [](const Vector<Record>& lhs, const Vector<Record>& rhs) {
+        return lhs.Size() == rhs.Size()
+            && std::memcmp(lhs.begin(), rhs.begin(), lhs.Size() * sizeof(Record)) == 0;
+    };
+    {
+        std::stringstream stream;
+        Serialize(stream, v);
+        assert(stream.str().size() == sizeof(SerializedHeader) + SIZE * sizeof(Record));
+        const auto restored = Deserialize<Vector<Record>>(stream);
+        assert(same(restored, v));
+
+        // Порча данных обнаруживается по контрольной сумме, чужой тип — по заголовку
+        std::string corrupted = stream.str();
+        corrupted[sizeof(SerializedHeader) + 5] ^= 1;
+        try {
+            std::stringstream corrupted_stream(corrupted);
+            Deserialize<Vector<Record>>(corrupted_stream);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        try {
+            std::stringstream wrong_type(stream.str());
+            Deserialize<Vector<double>>(wrong_type);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+
+        // Огромный count в заголовке не приводит к выделению памяти под несуществующие данные
+        for (uint64_t count : {uint64_t(1) << 40, std::numeric_limits<uint64_t>::max()}) {
+            SerializedHeader header = MakeSerializedHeader(std::span<const Record>(v.begin(), 10));
+            header.count = count;
+            std::string hostile(reinterpret_cast<const char*>(&header), sizeof(header));
+            hostile.append(reinterpret_cast<const char*>(v.begin()), 10 * sizeof(Record));
+            try {
+                std::stringstream hostile_stream(hostile);
+                Deserialize<Vector<Record>>(hostile_stream);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    {
+        int fds[2];
+        assert(::pipe(fds) == 0);
+        WriteVector(fds[1], v);
+        ::close(fds[1]);
+        const auto restored = ReadVector<Vector<Record>>(fds[0]);
+        ::close(fds[0]);
+        assert(same(restored, v));
+    }
+    {
+        SerializedHeader header = MakeSerializedHeader(std::span<const Record>(v.begin(), 1));
+        header.count = uint64_t(1) << 40;
+        int fds[2];
+        assert(::pipe(fds) == 0);
+        const ssize_t written = ::write(fds[1], &header, sizeof(header));
+        assert(written == static_cast<ssize_t>(sizeof(header)));
+        ::close(fds[1]);
+        try {
+            ReadVector<Vector<Record>>(fds[0]);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        ::close(fds[0]);
+    }
+#endif
+    {
+        // Буфер уходит из вектора и возвращается в другой без копирования элементов
+        Vector<Record> copy(v);
+        const Record* data = copy.begin();
+        ReleasedBuffer<Record> released = copy.Release();
+        assert(copy.Size() == 0 && copy.Capacity() == 0);
+        assert(released.data == data && released.size == SIZE && released.capacity >= SIZE);
+        auto adopted = Vector<Record>::Adopt(released.data, released.size, released.capacity);
+        assert(adopted.begin() == data && same(adopted, v));
+
+        std::allocator<Record> alloc;
+        Record* buffer = alloc.allocate(SIZE);
+        std::memcpy(static_cast<void*>(buffer), v.begin(), SIZE * sizeof(Record));
+        auto received = Vector<Record>::Adopt(buffer, SIZE, SIZE, alloc);
+        received.PushBack(Record{-1, 0});
+        assert(received.Size() == SIZE + 1 && received[SIZE - 1].id == static_cast<int>(SIZE - 1));
+    }
+}
+
+#ifdef ADVANCED_VECTOR_HAS_LARGE_PAGES
+void Test22() {
+    const size_t SMALL = 1000;
+    const size_t LARGE = size_t(1) << 20;
+    const LargePageOptions options{
+        .threshold_bytes = size_t(1) << 16,
+        .huge_pages = HugePageMode::kExplicit,
+        .numa_policy = NumaPolicy::kInterleave,
+        .numa_nodes = 1,
+        .prefault = true,
+    };
+    const LargePageAllocator<int> alloc(options);
+    {
+        LargePageVector<int> small(SMALL, alloc);
+        assert(small.Capacity() == SMALL);
+
+        // Крупный буфер выровнен по большой странице и занимает их целиком
+        LargePageVector<int> large(LARGE, alloc);
+        assert(reinterpret_cast<uintptr_t>(large.begin()) % kHugePageSize == 0);
+        assert(large.Capacity() * sizeof(int) % kHugePageSize == 0);
+        large[LARGE - 1] = 42;
+        large.PushBack(7);
+        assert(large[LARGE - 1] == 42 && large[LARGE] == 7);
+        assert(large.GetAllocator().GetOptions() == options);
+    }
+    {
+        // Вектор переходит порог при росте и продолжает расти с теми же параметрами
+        LargePageOptions transparent = options;
+        transparent.huge_pages = HugePageMode::kTransparent;
+        transparent.prefault = false;
+        LargePageVector<int> v{LargePageAllocator<int>(transparent)};
+        for (size_t i = 0; i < LARGE * 2; ++i) {
+            v.PushBack(static_cast<int>(i));
+            // Перенос через mremap сохраняет выравнивание по большой странице
+            assert(v.Capacity() * sizeof(int) < kHugePageSize
+                   || reinterpret_cast<uintptr_t>(v.begin()) % kHugePageSize == 0);
+        }
+        assert(v.Capacity() * sizeof(int) % kHugePageSize == 0);
+        v.Reserve(LARGE * 3);
+        v.ShrinkToFit();
+        assert(v.Size() == LARGE * 2 && v.Capacity() >= v.Size());
+        for (size_t i = 0; i < v.Size(); i += 4096) {
+            assert(v[i] == static_cast<int>(i));
+        }
+        assert(v.GetAllocator().GetOptions() == transparent);
+    }
+    {
+        // Хвост, добавленный ростом через mremap, предзаполняется так же, как новый буфер
+        LargePageOptions prefaulted = options;
+        prefaulted.huge_pages = HugePageMode::kTransparent;
+        prefaulted.numa_policy = NumaPolicy::kDefault;
+        LargePageVector<int> v(LARGE, LargePageAllocator<int>(prefaulted));
+        v.Reserve(LARGE * 8);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % kHugePageSize == 0);
+        const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t tail_bytes = v.Capacity() * sizeof(int) - LARGE * sizeof(int);
+        Vector<unsigned char> resident((tail_bytes + page_size - 1) / page_size);
+        if (::mincore(v.begin() + LARGE, tail_bytes, resident.begin()) == 0) {
+            for (size_t i = 0; i < resident.Size(); ++i) {
+                assert(resident[i] & 1);
+            }
+        }
+    }
+}
+#endif
+
+template <typename T>
+void CheckSearchAndCompare() {
+    // Длины покрывают целые SIMD-блоки и хвосты
+    for (size_t size : {0, 1, 3, 4, 7, 8, 9, 31, 64, 100}) {
+        Vector<T> v(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>(i % 50 + 1);
+        }
+        assert(v.Find(static_cast<T>(0)) == v.end() && !v.Contains(static_cast<T>(0)));
+        assert(v.Count(static_cast<T>(0)) == 0);
+        if (size != 0) {
+            const T last = v[size - 1];
+            assert(v.Find(last) == v.begin() + (size - 1) % 50);
+            assert(v.Count(static_cast<T>(1)) == (size + 49) / 50);
+        }
+
+        Vector<T> copy(v);
+        assert(copy == v && !(copy != v) && (copy <=> v) == 0);
+        if (size != 0) {
+            copy[size - 1] = static_cast<T>(100);
+            assert(copy != v && v < copy && copy > v);
+            copy.PopBack();
+            assert(copy < v);
+        }
+
+        v.Fill(static_cast<T>(7));
+        assert(v.Count(static_cast<T>(7)) == size);
+        v.Fill(static_cast<T>(0));
+        assert(v.Count(static_cast<T>(0)) == size);
+    }
+}
+
+void Test23() {
+    CheckSearchAndCompare<int32_t>();
+    CheckSearchAndCompare<uint32_t>();
+    CheckSearchAndCompare<int64_t>();
+    CheckSearchAndCompare<float>();
+    CheckSearchAndCompare<double>();
+    CheckSearchAndCompare<char>();
+    CheckSearchAndCompare<unsigned char>();
+    CheckSearchAndCompare<int16_t>();
+    {
+        // Числа с плавающей точкой сравниваются как числа, а не как байты
+        Vector<double> v{1.0, -0.0, std::nan(""), 2.0, 3.0};
+        assert(v.Contains(0.0) && v.Find(0.0) == v.begin() + 1);
+        assert(!v.Contains(std::nan("")));
+        assert(v != v);
+        assert(std::is_eq(Vector<float>{-0.0f} <=> Vector<float>{0.0f}));
+        assert((Vector<double>{std::nan("")} <=> Vector<double>{1.0}) == std::partial_ordering::unordered);
+    }
+    {
+        // Отрицательные числа сравниваются с учётом знака, хотя ищутся по битам
+        Vector<int32_t> lhs{1, 2, -3, 4, 5};
+        Vector<int32_t> rhs{1, 2, 3, 4, 5};
+        assert(lhs < rhs);
+        Vector<signed char> bytes{-1};
+        assert(bytes < Vector<signed char>{1});
+    }
+    {
+        enum class Color : uint32_t { kRed, kGreen, kBlue };
+        Vector<Color> colors{Color::kRed, Color::kBlue, Color::kBlue};
+        assert(colors.Count(Color::kBlue) == 2 && colors.Find(Color::kBlue) == colors.begin() + 1);
+        Vector<std::string> words{"a", "b", "c"};
+        assert(words.Contains("b") && words.Count("d") == 0);
+        assert(words < Vector<std::string>({"a", "c"}));
+        words.Fill("x");
+        assert(words == Vector<std::string>({"x", "x", "x"}));
+    }
+#ifdef ADVANCED_VECTOR_SIMD_SSE2
+    {
+        // Базовое ядро проверяется отдельно: на машине с AVX2 диспетчер до него не доходит
+        const uint64_t values[] = {1, 2, 3, 2, 5, 1ull << 40};
+        assert(simd_detail::FindSse2(values, 6, uint64_t(2)) == 1);
+        assert(simd_detail::FindSse2(values, 6, uint64_t(1) << 40) == 5);
+        assert(simd_detail::FindSse2(values, 6, uint64_t(2) << 40) == 6);
+        assert(simd_detail::CountSse2(values, 6, uint64_t(2)) == 2);
+        const uint64_t other[] = {1, 2, 3, 2, 5, 1};
+        assert(simd_detail::MismatchSse2(values, other, 6) == 5);
+        const float floats[] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f};
+        assert(simd_detail::FindSse2(floats, 5, 4.5f) == 4 && simd_detail::CountSse2(floats, 5, 1.5f) == 1);
+    }
+#endif
+}
+
+void Test24() {
+    {
+        // Присваивание чуть большего вектора растит буфер по политике роста, а не до точного размера
+        Vector<int, std::allocator<int>, DoublingGrowth, PerInstanceVectorStats> v;
+        for (int size = 1; size <= 1000; ++size) {
+            Vector<int> source(static_cast<size_t>(size));
+            std::iota(source.begin(), source.end(), size);
+            v.Assign(source.begin(), source.end());
+            assert(v.Size() == source.Size() && std::equal(v.begin(), v.end(), source.begin()));
+        }
+        assert(v.GetStats().Get().allocations == 11);
+        assert(v.Capacity() == 1024);
+
+        Vector<int> lhs;
+        for (size_t size = 1; size <= 1000; ++size) {
+            const Vector<int> rhs(size);
+            lhs = rhs;
+        }
+        assert(lhs.Size() == 1000 && lhs.Capacity() == 1024);
+    }
+    {
+        // Побайтовое копирование в уже занятый буфер корректно и для пересекающихся диапазонов
+        Vector<int> v{1, 2, 3, 4, 5};
+        v.Assign(v.begin() + 1, v.end());
+        assert((v == Vector<int>{2, 3, 4, 5}));
+        Vector<int> w{9, 9};
+        w.Reserve(10);
+        Vector<int> source{1, 2, 3, 4, 5, 6};
+        w.Assign(std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+        assert((w == Vector<int>{1, 2, 3, 4, 5, 6}) && w.Capacity() == 10);
+        w = Vector<int>{7};
+        assert(w.Size() == 1 && w[0] == 7);
+    }
+    {
+        // Ошибка копирования при выделении нового буфера оставляет вектор нетронутым
+        Obj::ResetCounters();
+        Vector<Obj> v(2);
+        Vector<Obj> source(10);
+        source[5].throw_on_copy = true;
+        try {
+            v = source;
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 2 && v.Capacity() == 2);
+        assert(Obj::GetAliveObjectCount() == 12);
+    }
+    Obj::ResetCounters();
+}
+
+void Test25() {
+    {
+        SoAVector<int, double, std::string> v;
+        for (int i = 0; i < 100; ++i) {
+            auto [id, value, name] = v.EmplaceBack(i, i * 0.5, std::to_string(i));
+            assert(id == i && value == i * 0.5 && name == std::to_string(i));
+        }
+        assert(v.Size() == 100 && v.Capacity() == 128);
+        // Столбцы непрерывны и живут отдельно друг от друга
+        std::span<int> ids = v.Column<0>();
+        std::span<double> values = v.Column<1>();
+        assert(ids.size() == 100 && values.size() == 100);
+        assert(std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+        assert(simd_detail::FindIndex(ids.data(), ids.size(), 42) == 42);
+        for (double& value : values) {
+            value *= 2;
+        }
+        // Строка — кортеж ссылок: через неё меняются элементы столбцов
+        std::get<2>(v[7]) = "seven";
+        v[8] = std::make_tuple(-8, -8.0, std::string("minus eight"));
+        assert(v.Column<2>()[7] == "seven" && v.Column<0>()[8] == -8);
+        size_t rows = 0;
+        for (auto [id, value, name] : v) {
+            assert(value == (id == -8 ? -8.0 : id));
+            ++rows;
+        }
+        assert(rows == 100);
+
+        auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(it == v.begin() + 10 && std::get<0>(*it) == 20 && v.Size() == 90);
+        v.Erase(v.begin());
+        assert(std::get<0>(v[0]) == 1 && std::get<2>(v[0]) == "1");
+        v.PopBack();
+        assert(std::get<2>(v[v.Size() - 1]) == "98");
+
+        const auto copy = v;
+        assert(copy.Size() == v.Size() && copy.Capacity() == v.Size());
+        assert(std::equal(copy.begin(), copy.end(), v.begin()));
+        auto moved = std::move(v);
+        assert(v.Size() == 0 && moved.Size() == 88);
+        moved.PushBack({1000, 1.0, "pushed"});
+        const auto& back = moved[moved.Size() - 1];
+        assert(std::get<0>(back) == 1000 && std::get<2>(back) == "pushed");
+        moved.Resize(10);
+        moved.ShrinkToFit();
+        assert(moved.Size() == 10 && moved.Capacity() == 10);
+        moved.Resize(12);
+        assert(std::get<0>(moved[11]) == 0 && std::get<2>(moved[11]).empty());
+    }
+    {
+        // Поля, которые нельзя перенести без исключений, копируются до переноса остальных,
+        // поэтому ошибка копирования при росте оставляет все столбцы нетронутыми
+        static_assert(!std::is_nothrow_move_constructible_v<CopyOnly>);
+
+        Obj::ResetCounters();
+        {
+            SoAVector<Obj, CopyOnly, std::unique_ptr<int>> v;
+            v.Reserve(4);
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i, CopyOnly(i), std::make_unique<int>(i));
+            }
+            CopyOnly::throw_on_copy_of = 2;
+            try {
+                v.EmplaceBack(4, CopyOnly(4), std::make_unique<int>(4));
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            CopyOnly::throw_on_copy_of = -1;
+            assert(v.Size() == 4 && v.Capacity() == 4);
+            assert(Obj::GetAliveObjectCount() == 4);
+            for (int i = 0; i < 4; ++i) {
+                auto [obj, copy_only, ptr] = v[i];
+                assert(obj.id == i && copy_only.value == i && *ptr == i);
+            }
+            v.EmplaceBack(4, CopyOnly(4), std::make_unique<int>(4));
+            assert(v.Size() == 5 && *std::get<2>(v[4]) == 4 && Obj::GetAliveObjectCount() == 5);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        Obj::ResetCounters();
+    }
+    {
+        // Некопируемое поле с бросающим перемещением переносится перемещением: исключение
+        // не завершает программу, строки и остальные поля остаются на месте
+        static_assert(!std::is_nothrow_move_constructible_v<MoveOnlyThrowing>);
+
+        Obj::ResetCounters();
+        {
+            SoAVector<Obj, MoveOnlyThrowing, std::string> v;
+            v.Reserve(4);
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i, MoveOnlyThrowing(i), std::to_string(i));
+            }
+            MoveOnlyThrowing::throw_on_move_of = 2;
+            try {
+                v.Reserve(8);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            MoveOnlyThrowing::throw_on_move_of = -1;
+            assert(v.Size() == 4 && v.Capacity() == 4);
+            assert(Obj::GetAliveObjectCount() == 4);
+            for (int i = 0; i < 4; ++i) {
+                auto [obj, move_only, name] = v[i];
+                assert(obj.id == i && move_only.value == i && name == std::to_string(i));
+            }
+            v.EmplaceBack(4, MoveOnlyThrowing(4), "4");
+            assert(v.Size() == 5 && v.Capacity() >= 5 && std::get<1>(v[4]).value == 4);
+            for (int i = 0; i < 5; ++i) {
+                assert(std::get<0>(v[i]).id == i && std::get<1>(v[i]).value == i);
+            }
+            assert(Obj::GetAliveObjectCount() == 5);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        Obj::ResetCounters();
+    }
+}
+
+void Test26() {
+    {
+        static constexpr auto kSquares = MakeSquares();
+        static_assert(kSquares.Size() == 16 && kSquares[15] == 225);
+        static_assert(CheckConstexprVector());
+        static_assert(CheckConstexprStaticVector());
+        static_assert(std::is_trivially_copyable_v<StaticVector<int, 16>>);
+        static_assert(std::is_trivially_destructible_v<StaticVector<std::pair<int, int>, 4>>);
+        static_assert(!std::is_trivially_copyable_v<StaticVector<std::string, 4>>);
+        assert(std::accumulate(kSquares.begin(), kSquares.end(), 0) == 1240);
+        assert(CheckConstexprVector() && CheckConstexprStaticVector());
+    }
+    {
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 8> v;
+            for (int i = 0; i < 8; ++i) {
+                v.EmplaceBack(i);
+            }
+            try {
+                v.EmplaceBack(8);
+                assert(false && "Exception is expected");
+            } catch (const std::bad_alloc&) {
+            }
+            assert(v.Size() == 8 && Obj::GetAliveObjectCount() == 8);
+            v.Erase(v.begin() + 2, v.begin() + 4);
+            assert(v.Size() == 6 && v[2].id == 4 && Obj::GetAliveObjectCount() == 6);
+            v.Emplace(v.begin() + 1, 100);
+            assert(v[1].id == 100 && v[2].id == 1);
+            auto copy = v;
+            assert(copy.Size() == 7 && Obj::GetAliveObjectCount() == 14);
+            copy.Resize(2);
+            copy = v;
+            assert(copy.Size() == 7 && copy[6].id == 7);
+            v.Clear();
+            v = std::move(copy);
+            assert(v.Size() == 7 && v[0].id == 0 && Obj::GetAliveObjectCount() == 14);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        Obj::ResetCounters();
+    }
+    {
+        // Тривиальные элементы копируются вместе с хранилищем целиком
+        StaticVector<int, 4> v{1, 2, 3};
+        StaticVector<int, 4> copy = v;
+        copy.PushBack(4);
+        assert(v.Size() == 3 && copy.Size() == 4 && copy[3] == 4);
+        assert(v < copy && copy != v);
+        copy = v;
+        assert(copy == v);
+        try {
+            StaticVector<int, 4> too_big(5);
+            assert(false && "Exception is expected");
+        } catch (const std::bad_alloc&) {
+        }
+    }
+}
+
+void Test27() {
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            assert(v.UncheckedEmplaceBack(i).id == i);
+        }
+        assert(v.Size() == 4 && v.Capacity() == 4 && Obj::num_constructed_with_id == 4);
+        // Рост из медленного пути сохраняет перенос без копирования и ссылки на свои элементы
+        v.EmplaceBack(v[0]);
+        assert(v.Size() == 5 && v.Capacity() == 8 && v[4].id == 0);
+        assert(Obj::num_copied == 1 && Obj::num_moved == 4);
+        v.PushBack(v[1]);
+        assert(v[5].id == 1 && Obj::num_copied == 2 && Obj::num_moved == 4);
+        v.Clear();
+        Obj::ResetCounters();
+    }
+    {
+        // Декодер выделяет место под пакет и пишет в него напрямую
+        Vector<uint32_t, std::allocator<uint32_t>, DoublingGrowth, PerInstanceVectorStats> v;
+        for (uint32_t packet = 0; packet < 100; ++packet) {
+            uint32_t* slots = v.GrowBy(16);
+            for (uint32_t i = 0; i < 16; ++i) {
+                slots[i] = packet * 16 + i;
+            }
+        }
+        assert(v.Size() == 1600 && v.Capacity() == 2048);
+        assert(v.GetStats().Get().allocations == 8);
+        for (uint32_t i = 0; i < 1600; ++i) {
+            assert(v[i] == i);
+        }
+        assert(v.GrowBy(0) == v.end());
+
+        Vector<std::string> strings{"a"};
+        std::string* fresh = strings.GrowBy(3);
+        assert(strings.Size() == 4 && fresh == strings.begin() + 1 && fresh[2].empty());
+        fresh[0] = "b";
+        assert(strings[1] == "b");
+    }
+}
+
+void Test28() {
+    BufferPool& pool = BufferPool::ThisThread();
+    pool.Flush();
+    {
+        // Вектор получает весь блок класса размеров, а освобождённый блок достаётся следующему
+        const BufferPoolStats before = pool.GetStats();
+        {
+            PooledVector<int> v;
+            v.Reserve(5);
+            assert(v.Capacity() == BufferPool::kMinBlockSize / sizeof(int));
+        }
+        assert(pool.GetStats().cached_blocks == 1);
+        for (int round = 0; round < 10; ++round) {
+            PooledVector<int> v;
+            v.Resize(8);
+            v[7] = round;
+        }
+        const BufferPoolStats after = pool.GetStats();
+        assert(after.misses - before.misses == 1 && after.hits - before.hits == 10);
+        assert(after.cached_blocks == 1 && after.cached_bytes == BufferPool::kMinBlockSize);
+    }
+    {
+        // Рост через несколько классов оставляет в кэше по блоку на класс
+        pool.Flush();
+        PooledVector<std::string> strings;
+        for (int i = 0; i < 100; ++i) {
+            strings.EmplaceBack(std::to_string(i));
+        }
+        assert(strings[99] == "99");
+        const size_t cached = pool.GetStats().cached_blocks;
+        assert(cached > 0);
+        strings = PooledVector<std::string>();
+        assert(pool.GetStats().cached_blocks == cached + 1);
+        pool.Flush();
+        assert(pool.GetStats().cached_blocks == 0 && pool.GetStats().cached_bytes == 0);
+    }
+    {
+        // Крупные буферы идут мимо кэша, а ограничения сбрасывают лишние блоки
+        const BufferPoolStats before = pool.GetStats();
+        {
+            PooledVector<char> big(BufferPool::kMaxBlockSize + 1);
+        }
+        assert(pool.GetStats().misses == before.misses && pool.GetStats().cached_blocks == 0);
+
+        const BufferPoolLimits default_limits = pool.GetLimits();
+        {
+            Vector<PooledVector<int>> vectors(10);
+            for (auto& v : vectors) {
+                v.Reserve(1);
+            }
+        }
+        assert(pool.GetStats().cached_blocks == 10);
+        pool.SetLimits({4, default_limits.max_cached_bytes});
+        assert(pool.GetStats().cached_blocks == 4);
+        pool.SetLimits({4, BufferPool::kMinBlockSize * 2});
+        assert(pool.GetStats().cached_blocks == 2);
+        {
+            PooledVector<int> v;
+            v.Reserve(100);
+        }
+        assert(pool.GetStats().cached_blocks == 2);
+        pool.SetLimits(default_limits);
+        pool.Flush();
+    }
+    {
+        // Буфер, созданный в одном потоке, можно освободить в другом; кэши потоков независимы
+        PooledVector<int> shared(10);
+        std::thread worker([&shared] {
+            BufferPool& worker_pool = BufferPool::ThisThread();
+            assert(worker_pool.GetStats().cached_blocks == 0);
+            PooledVector<int> local = std::move(shared);
+            local.PushBack(2);
+            assert(local.Size() == 11);
+            local = PooledVector<int>();
+            assert(worker_pool.GetStats().cached_blocks == 1);
+        });
+        worker.join();
+        assert(pool.GetStats().cached_blocks == 0);
+    }
+}
+
+void Test29() {
+    {
+        // Копии разделяют буфер, а чтение через const-путь его не отделяет
+        Obj::ResetCounters();
+        const CowVector<Obj> snapshot(Vector<Obj>(3));
+        assert(Obj::num_default_constructed == 3);
+        CowVector<Obj> reader = snapshot;
+        CowVector<Obj> writer = snapshot;
+        assert(snapshot.UseCount() == 3 && Obj::num_copied == 0);
+        assert(std::as_const(reader)[0].id == 0 && reader.Get().begin() == snapshot.begin());
+        for (const Obj& obj : std::as_const(reader)) {
+            assert(obj.id == 0);
+        }
+        assert(Obj::num_copied == 0);
+
+        // Первое изменение создаёт собственную копию, последующие идут на месте
+        writer[1].id = 5;
+        assert(Obj::num_copied == 3 && writer.UseCount() == 1 && snapshot.UseCount() == 2);
+        writer[2].id = 6;
+        assert(Obj::num_copied == 3);
+        assert(snapshot[1].id == 0 && writer.Get()[1].id == 5);
+
+        // Вставка элемента разделяемого буфера: буфер живёт до конца вставки
+        reader.PushBack(reader.Get()[0]);
+        assert(reader.Size() == 4 && snapshot.Size() == 3 && snapshot.UseCount() == 1);
+        reader.Erase(reader.cbegin() + 1, reader.cbegin() + 3);
+        assert(reader.Size() == 2);
+
+        CowVector<Obj> cleared = snapshot;
+        cleared.Clear();
+        assert(cleared.Empty() && cleared.UseCount() == 0 && snapshot.UseCount() == 1);
+        cleared.EmplaceBack(7);
+        assert(cleared.Size() == 1 && cleared.Get()[0].id == 7);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        CowVector<int> empty;
+        assert(empty.Empty() && empty.begin() == empty.end());
+        CowVector<int> copy = empty;
+        copy.PushBack(1);
+        assert(copy.Size() == 1 && empty.Empty());
+
+        CowVector<int> numbers{1, 2, 3};
+        CowVector<int> moved = std::move(numbers);
+        assert(moved.UseCount() == 1 && numbers.Empty());
+        numbers = moved;
+        numbers = moved;
+        assert(moved.UseCount() == 2 && numbers == moved);
+        numbers.PopBack();
+        assert(numbers.Size() == 2 && moved.Size() == 3 && moved.UseCount() == 1 && !(numbers == moved));
+    }
+    {
+        // Читатели и писатели в разных потоках работают со своими экземплярами
+        const CowVector<int> snapshot(Vector<int>(1000));
+        Vector<std::thread> threads;
+        std::atomic<size_t> total = 0;
+        for (int t = 0; t < 4; ++t) {
+            threads.EmplaceBack([copy = snapshot, t, &total]() mutable {
+                if (t % 2 == 0) {
+                    total += std::accumulate(std::as_const(copy).begin(), std::as_const(copy).end(), size_t(0));
+                }
+                else {
+                    for (int& value : copy) {
+                        value = t;
+                    }
+                    total += std::accumulate(copy.begin(), copy.end(), size_t(0));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(total == 4000 && snapshot.UseCount() == 1);
+    }
+    {
+        // Ссылка, выданная до копирования, не меняет копию: копия получает свой буфер
+        CowVector<int> original{1, 2, 3};
+        int& first = original[0];
+        CowVector<int> copy = original;
+        assert(copy.UseCount() == 1 && original.UseCount() == 1);
+        first = 42;
+        assert(std::as_const(copy)[0] == 1 && std::as_const(original)[0] == 42);
+
+        auto it = original.begin();
+        CowVector<int> assigned;
+        assigned = original;
+        *it = 7;
+        assert(std::as_const(assigned)[0] == 42);
+
+        int& last = original.EmplaceBack(4);
+        CowVector<int> after_emplace = original;
+        last = 5;
+        assert(std::as_const(after_emplace)[3] == 4);
+
+        // После перевыделения прежние ссылки недействительны, и буфер снова разделяется
+        original.Reserve(original.Capacity() * 4);
+        CowVector<int> shared = original;
+        assert(original.UseCount() == 2 && shared.Get().begin() == original.Get().begin());
+
+        // Ссылка на вектор из Mutable переживает перевыделение, поэтому копии после неё
+        // всегда получают свой буфер
+        CowVector<int> cow{1, 2, 3};
+        auto& items = cow.Mutable();
+        items.Reserve(2 * items.Capacity());
+        CowVector<int> snap = cow;
+        items[0] = 42;
+        assert(snap.UseCount() == 1 && std::as_const(snap)[0] == 1 && std::as_const(cow)[0] == 42);
+
+        // Присваивание отпускает буфер, и новый снова разделяется
+        cow = CowVector<int>{4, 5};
+        CowVector<int> cow_copy = cow;
+        assert(cow.UseCount() == 2);
+
+        // PushBack ссылок не выдаёт и разделению не мешает
+        CowVector<int> appended;
+        appended.PushBack(1);
+        CowVector<int> appended_copy = appended;
+        assert(appended.UseCount() == 2);
+    }
+}
+
+void Test30() {
+    {
+        // Двоичный поиск и индекс Эйтцингера совпадают с std::set на всех размерах
+        for (int size = 0; size < 70; ++size) {
+            FlatSet<int> flat;
+            std::set<int> reference;
+            Vector<int> keys;
+            for (int i = 0; i < size; ++i) {
+                keys.PushBack(i * 3);
+                reference.insert(i * 3);
+            }
+            flat.InsertSorted(keys);
+            assert(flat.Size() == reference.size() && !flat.HasIndex());
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int key = -2; key < size * 3 + 2; ++key) {
+                    const auto expected = reference.lower_bound(key);
+                    const size_t expected_pos = std::distance(reference.begin(), expected);
+                    assert(static_cast<size_t>(flat.LowerBound(key) - flat.begin()) == expected_pos);
+                    assert(flat.Contains(key) == (reference.count(key) > 0));
+                }
+                flat.BuildIndex();
+                assert(flat.HasIndex() == (size > 0));
+            }
+        }
+    }
+    {
+        // Слияние пропускает дубликаты и сбрасывает индекс
+        FlatSet<std::string> flat;
+        assert(flat.Insert("m").second && !flat.Insert("m").second);
+        flat.BuildIndex();
+        const std::string batch[] = {"a", "c", "c", "m", "z"};
+        flat.InsertSorted(std::begin(batch), std::end(batch));
+        assert(!flat.HasIndex());
+        assert((flat.Keys() == Vector<std::string>{"a", "c", "m", "z"}));
+        std::istringstream input("b d");
+        flat.InsertSorted(std::istream_iterator<std::string>(input), std::istream_iterator<std::string>());
+        assert((flat.Keys() == Vector<std::string>{"a", "b", "c", "d", "m", "z"}));
+        assert(flat.Erase("c") == 1 && flat.Erase("c") == 0 && flat.Find("c") == flat.end());
+        assert(*flat.Find("d") == "d");
+    }
+    {
+        FlatMap<int, std::string> flat;
+        std::map<int, std::string> reference;
+        flat.Reserve(64);
+        assert(flat.Capacity() >= 64);
+        // Ключи, продолжающие отображение, дописываются без слияния
+        const std::pair<int, std::string> tail[] = {{10, "ten"}, {20, "twenty"}, {30, "thirty"}};
+        flat.InsertSorted(tail);
+        reference.insert(std::begin(tail), std::end(tail));
+        const std::pair<int, std::string> batch[] = {{5, "five"}, {20, "other"}, {25, "a"}, {25, "b"}};
+        flat.InsertSorted(batch);
+        reference.insert(std::begin(batch), std::end(batch));
+        assert(flat.Size() == reference.size());
+        size_t index = 0;
+        for (const auto& [key, value] : reference) {
+            assert(flat.Keys()[index] == key && flat.Values()[index] == value);
+            ++index;
+        }
+        flat.BuildIndex();
+        assert(*flat.Find(25) == "a" && flat.Find(26) == nullptr && flat.At(20) == "twenty");
+        flat[7] = "seven";
+        assert(!flat.HasIndex() && flat.Keys()[1] == 7 && flat.Values()[1] == "seven");
+        assert(!flat.TryEmplace(7, "again").second && flat.Insert(8, "eight").second);
+        assert(flat.Erase(5) == 1 && flat.Contains(8) && !flat.Contains(5));
+        try {
+            flat.At(100);
+            assert(false);
+        }
+        catch (const std::out_of_range&) {
+        }
+        flat.Clear();
+        assert(flat.Empty() && flat.Values().Size() == 0);
+    }
+    {
+        // Исключение при слиянии оставляет множество и отображение нетронутыми
+        const auto by_value = [](const CopyOnly& lhs, const CopyOnly& rhs) {
+            return lhs.value < rhs.value;
+        };
+        FlatSet<CopyOnly, decltype(by_value)> set(by_value);
+        const CopyOnly keys[] = {CopyOnly(1), CopyOnly(3), CopyOnly(5)};
+        set.InsertSorted(std::begin(keys), std::end(keys));
+        const CopyOnly batch[] = {CopyOnly(0), CopyOnly(2), CopyOnly(4)};
+        CopyOnly::throw_on_copy_of = 3;
+        try {
+            set.InsertSorted(std::begin(batch), std::end(batch));
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        CopyOnly::throw_on_copy_of = -1;
+        assert(set.Size() == 3);
+        for (size_t i = 0; i < set.Size(); ++i) {
+            assert(set.Keys()[i].value == static_cast<int>(2 * i + 1));
+        }
+
+        FlatMap<std::string, CopyOnly> map;
+        const std::pair<std::string, CopyOnly> items[] = {{"b", CopyOnly(1)}, {"d", CopyOnly(3)}};
+        map.InsertSorted(items);
+        const std::pair<std::string, CopyOnly> more[] = {{"a", CopyOnly(0)}, {"c", CopyOnly(2)}};
+        CopyOnly::throw_on_copy_of = 3;
+        try {
+            map.InsertSorted(more);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        CopyOnly::throw_on_copy_of = -1;
+        assert((map.Keys() == Vector<std::string>{"b", "d"}));
+        assert(map.Values()[0].value == 1 && map.Values()[1].value == 3);
+        map.InsertSorted(more);
+        assert((map.Keys() == Vector<std::string>{"a", "b", "c", "d"}) && map.Values()[2].value == 2);
+    }
+}
+
+void Test31() {
+    {
+        // Очередь по кругу: вместимость не растёт, пока размер не превышает её
+        CircularVector<int> queue;
+        queue.Reserve(8);
+        const size_t capacity = queue.Capacity();
+        for (int i = 0; i < 1000; ++i) {
+            queue.PushBack(i);
+            if (queue.Size() > 5) {
+                assert(queue.Front() == i - 5);
+                queue.PopFront();
+            }
+        }
+        assert(queue.Capacity() == capacity && queue.Size() == 5 && queue.Back() == 999);
+        assert(queue[0] == 995 && queue[4] == 999);
+
+        // Содержимое, перешедшее через конец буфера, лежит в двух отрезках
+        const auto [first, second] = std::as_const(queue).AsSpans();
+        assert(first.size() + second.size() == 5);
+        Vector<int> joined;
+        joined.Append(first);
+        joined.Append(second);
+        assert((joined == Vector<int>{995, 996, 997, 998, 999}));
+        const std::span<int> linear = queue.Linearize();
+        assert(linear.size() == 5 && linear[0] == 995 && queue.AsSpans().second.empty());
+
+        queue.PushFront(994);
+        queue.PushFront(993);
+        queue.PopBack();
+        assert(queue.Front() == 993 && queue.Back() == 998 && queue.Size() == 6);
+        assert(std::accumulate(queue.begin(), queue.end(), 0) == 993 + 994 + 995 + 996 + 997 + 998);
+    }
+    {
+        // Рост из переходящего через конец состояния переносит элементы по порядку, без копий
+        Obj::ResetCounters();
+        {
+            CircularVector<Obj> queue;
+            for (int i = 0; i < 4; ++i) {
+                queue.EmplaceBack(i);
+            }
+            const size_t capacity = queue.Capacity();
+            queue.PopFront();
+            queue.PopFront();
+            while (queue.Size() < capacity) {
+                queue.EmplaceBack(static_cast<int>(queue.Size()) + 2);
+            }
+            assert(!queue.AsSpans().second.empty());
+            const int copied = Obj::num_copied;
+            const int relocated = Obj::num_moved;
+            // Аргумент ссылается на элемент, который переедет при росте
+            queue.PushBack(queue.Front());
+            assert(queue.Capacity() > capacity && queue.Back().id == 2 && queue.Front().id == 2);
+            assert(Obj::num_copied - copied == 1 && Obj::num_moved - relocated == static_cast<int>(capacity));
+            queue.PushFront(Obj(1));
+            for (size_t i = 0; i + 1 < queue.Size() - 1; ++i) {
+                assert(queue[i].id == static_cast<int>(i) + 1);
+            }
+            CircularVector<Obj> copy = queue;
+            assert(copy.Size() == queue.Size() && copy.Front().id == 1);
+            CircularVector<Obj> moved = std::move(copy);
+            assert(copy.Empty() && moved.Size() == queue.Size());
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Исключение при росте оставляет очередь прежней
+        CircularVector<CopyOnly> queue;
+        queue.EmplaceBack(1);
+        queue.EmplaceBack(2);
+        while (queue.Size() < queue.Capacity()) {
+            queue.EmplaceBack(3);
+        }
+        queue.PopFront();
+        queue.EmplaceBack(4);
+        const size_t size = queue.Size();
+        CopyOnly::throw_on_copy_of = 4;
+        try {
+            queue.EmplaceBack(5);
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        CopyOnly::throw_on_copy_of = -1;
+        assert(queue.Size() == size && queue.Front().value == 2 && queue.Back().value == 4);
+        CircularVector<int> lhs{1, 2, 3};
+        CircularVector<int> rhs;
+        rhs.PushFront(3);
+        rhs.PushFront(2);
+        rhs.PushFront(1);
+        assert(lhs == rhs);
+    }
+}
+
+void Test32() {
+    using CopiedRecord = ThrowingMoveRecord<false>;
+    using MovedRecord = ThrowingMoveRecord<true>;
+    static_assert(RelocatesByCopyV<CopiedRecord> && !RelocatesByCopyV<MovedRecord>);
+    static_assert(!RelocatesByCopyV<std::unique_ptr<int>> && !RelocatesByCopyV<int> && !RelocatesByCopyV<Obj>);
+    {
+        // Без признака рост копирует элементы, с признаком — перемещает
+        Vector<CopiedRecord, std::allocator<CopiedRecord>, DoublingGrowth, PerInstanceVectorStats> copied;
+        Vector<MovedRecord, std::allocator<MovedRecord>, DoublingGrowth, PerInstanceVectorStats> moved;
+        for (int i = 0; i < 17; ++i) {
+            copied.EmplaceBack(std::to_string(i));
+            moved.EmplaceBack(std::to_string(i));
+        }
+        assert(CopiedRecord::num_copied == 31 && CopiedRecord::num_moved == 0);
+        assert(MovedRecord::num_copied == 0 && MovedRecord::num_moved == 31);
+        assert(copied.GetStats().Get().elements_copied == 31 && copied.GetStats().Get().elements_moved == 0);
+        assert(moved.GetStats().Get().elements_copied == 0 && moved.GetStats().Get().elements_moved == 31);
+        assert(moved[16].name == "16");
+
+        CircularVector<MovedRecord> queue;
+        queue.EmplaceBack("a");
+        queue.EmplaceBack("b");
+        assert(MovedRecord::num_copied == 0 && queue.Back().name == "b");
+    }
+    {
+        // Исключение при перемещении оставляет прежний буфер и размер, но элементы могут
+        // оказаться перемещёнными: гарантия базовая
+        Vector<MovedRecord> v;
+        v.Reserve(2);
+        v.EmplaceBack("first");
+        v.EmplaceBack("second");
+        const MovedRecord* old_data = v.begin();
+        MovedRecord::throw_on_move_of = "second";
+        try {
+            v.EmplaceBack("third");
+            assert(false);
+        }
+        catch (const std::runtime_error&) {
+        }
+        MovedRecord::throw_on_move_of.clear();
+        assert(v.Size() == 2 && v.begin() == old_data);
+        v.EmplaceBack("third");
+        assert(v.Size() == 3 && v[2].name == "third");
+    }
+}
+
+void Test33() {
+    {
+        // Обход вектора указателей с упреждением видит все элементы по порядку при любой дальности
+        Vector<int> values;
+        for (int i = 0; i < 100; ++i) {
+            values.PushBack(i);
+        }
+        Vector<int*> pointers;
+        for (int i = 99; i >= 0; --i) {
+            pointers.PushBack(&values[static_cast<size_t>(i)]);
+        }
+        for (size_t distance : {size_t(0), size_t(1), size_t(8), size_t(100), size_t(1000)}) {
+            Vector<int> visited;
+            pointers.ForEachPrefetched(distance, [&visited](int* value) {
+                visited.PushBack(*value);
+            });
+            assert(visited.Size() == 100 && visited[0] == 99 && visited[99] == 0);
+            int sum = 0;
+            for (const int* value : std::as_const(pointers).Prefetched(distance)) {
+                sum += *value;
+            }
+            assert(sum == 4950);
+        }
+        for (int& value : values.Prefetched()) {
+            value *= 2;
+        }
+        assert(values[99] == 198 && *pointers[0] == 198);
+        int total = 0;
+        std::as_const(values).ForEachPrefetched(4, [&total](const int& value) {
+            total += value;
+        });
+        assert(total == 9900);
+        Vector<int> empty;
+        assert(empty.Prefetched().begin() == empty.Prefetched().end());
+    }
+    {
+        const Vector<std::string> names{"zero", "one", "two", "three", "four"};
+        const Vector<uint32_t> indices{4, 0, 4, 2};
+        assert((names.Gather(indices) == Vector<std::string>{"four", "zero", "four", "two"}));
+        const std::vector<size_t> more{1, 3};
+        assert((names.Gather(more, 0) == Vector<std::string>{"one", "three"}));
+        assert(names.Gather(Vector<int>()).Size() == 0);
+
+        Vector<uint64_t> table(1000);
+        std::iota(table.begin(), table.end(), uint64_t(0));
+        Vector<size_t> random_indices;
+        for (size_t i = 0; i < 300; ++i) {
+            random_indices.PushBack(i * 7919 % 1000);
+        }
+        const Vector<uint64_t> gathered = table.Gather(random_indices, 16);
+        assert(gathered.Size() == 300 && gathered.Capacity() == 300);
+        for (size_t i = 0; i < 300; ++i) {
+            assert(gathered[i] == random_indices[i]);
+        }
+    }
+}
+
+void Test34() {
+    using TracedVector = Vector<int, std::allocator<int>, DoublingGrowth, TracingVectorStats<PerInstanceVectorStats>>;
+    GrowthTrace& trace = GrowthTrace::ThisThread();
+    trace.Clear();
+    {
+        // Каждый рост записывается с операцией, вместимостями и строкой вызова в этом файле
+        TracedVector v;
+        const uint_least32_t reserve_line = __LINE__ + 1;
+        v.Reserve(3);
+        v.PushBack(1);
+        v.PushBack(2);
+        v.PushBack(3);
+        const uint_least32_t push_line = __LINE__ + 1;
+        v.PushBack(4);
+        const uint_least32_t resize_line = __LINE__ + 1;
+        v.Resize(20);
+        v.Reserve(5);
+        v.Resize(1);
+
+        const Vector<GrowthEvent> events = trace.Events();
+        assert(events.Size() == 3 && trace.Dropped() == 0);
+        assert(std::strcmp(events[0].operation, "Reserve") == 0);
+        assert(events[0].old_capacity == 0 && events[0].new_capacity == 3 && events[0].elements_relocated == 0);
+        assert(events[0].location.line() == reserve_line);
+        assert(std::string_view(events[0].location.file_name()).ends_with("main.cpp"));
+        assert(std::strcmp(events[1].operation, "PushBack") == 0);
+        assert(events[1].old_capacity == 3 && events[1].new_capacity == 6 && events[1].elements_relocated == 3);
+        assert(events[1].location.line() == push_line);
+        assert(std::strcmp(events[2].operation, "Resize") == 0);
+        assert(events[2].old_capacity == 6 && events[2].new_capacity == 20 && events[2].elements_relocated == 4);
+        assert(events[2].location.line() == resize_line);
+        assert(events[1].start >= events[0].start && events[2].elapsed.count() >= 0);
+        assert(events[2].new_capacity * events[2].element_size == 20 * sizeof(int));
+
+        // Счётчики базовой политики работают как раньше
+        assert(v.GetStats().reallocations == 2 && v.GetStats().elements_relocated == 7);
+    }
+    {
+        // Вставка в середину с ростом записывается как Insert
+        trace.Clear();
+        TracedVector v;
+        v.Reserve(2);
+        v.PushBack(1);
+        v.PushBack(3);
+        const uint_least32_t insert_line = __LINE__ + 1;
+        v.Insert(v.cbegin() + 1, 2);
+        assert(trace.Size() == 2 && std::strcmp(trace.Events()[1].operation, "Insert") == 0);
+        assert(trace.Events()[1].location.line() == insert_line);
+        const int value = 4;
+        v.Insert(v.cend(), value);
+        v.Insert(v.cbegin(), 0);
+        assert(trace.Size() == 3 && trace.Events()[2].location.line() == __LINE__ - 1);
+        assert(std::string_view(trace.Events()[2].location.file_name()).ends_with("main.cpp"));
+        for (int i = 5; i <= 8; ++i) {
+            v.Emplace(v.cend(), i);
+        }
+        assert(trace.Size() == 4 && std::string_view(trace.Events()[3].location.file_name()).ends_with("vector.h"));
+        assert((v == TracedVector{0, 1, 2, 3, 4, 5, 6, 7, 8}));
+
+        // EmplaceBackAt и EmplaceAt записывают переданное место вызова
+        v.Resize(v.Capacity());
+        const uint_least32_t emplace_back_line = __LINE__ + 1;
+        v.EmplaceBackAt(std::source_location::current(), 9);
+        assert(trace.Size() == 5 && std::strcmp(trace.Events()[4].operation, "PushBack") == 0);
+        assert(trace.Events()[4].location.line() == emplace_back_line);
+        v.Resize(v.Capacity());
+        const uint_least32_t emplace_line = __LINE__ + 1;
+        v.EmplaceAt(std::source_location::current(), v.cbegin(), -1);
+        assert(trace.Size() == 6 && std::strcmp(trace.Events()[5].operation, "Insert") == 0);
+        assert(trace.Events()[5].location.line() == emplace_line && v[0] == -1);
+        assert(std::string_view(trace.Events()[5].location.file_name()).ends_with("main.cpp"));
+    }
+    {
+        // Gather и конструктор из однопроходного диапазона записывают строку вызова
+        trace.Clear();
+        const TracedVector source{1, 2, 3, 4};
+        const size_t indices[] = {3, 0, 2};
+        const uint_least32_t gather_line = __LINE__ + 1;
+        const TracedVector gathered = source.Gather(indices);
+        assert((gathered == TracedVector{4, 1, 3}));
+        std::istringstream input("1 2 3");
+        const uint_least32_t construct_line = __LINE__ + 1;
+        const TracedVector parsed(std::istream_iterator<int>(input), std::istream_iterator<int>{});
+        assert(parsed.Size() == 3);
+        const Vector<GrowthEvent> events = trace.Events();
+        assert(events.Size() >= 2 && std::strcmp(events[0].operation, "Reserve") == 0);
+        assert(events[0].location.line() == gather_line);
+        for (size_t i = 1; i < events.Size(); ++i) {
+            assert(std::strcmp(events[i].operation, "Construct") == 0 && events[i].location.line() == construct_line);
+        }
+    }
+    {
+        // Пакетные вставки и присваивания записываются одним событием со строкой вызова
+        trace.Clear();
+        TracedVector v;
+        const int values[] = {1, 2, 3, 4, 5};
+        const uint_least32_t append_line = __LINE__ + 1;
+        v.Append(values);
+        const uint_least32_t insert_line = __LINE__ + 1;
+        v.Insert(v.cbegin(), 10, 0);
+        const uint_least32_t assign_line = __LINE__ + 1;
+        v.Assign(100, 1);
+        std::istringstream input("7 8 9");
+        const uint_least32_t input_line = __LINE__ + 1;
+        v.Insert(v.cend(), std::istream_iterator<int>(input), std::istream_iterator<int>());
+
+        const Vector<GrowthEvent> events = trace.Events();
+        assert(events.Size() == 4);
+        assert(std::strcmp(events[0].operation, "Append") == 0 && events[0].location.line() == append_line);
+        assert(std::strcmp(events[1].operation, "Insert") == 0 && events[1].location.line() == insert_line);
+        assert(events[1].old_capacity == 5 && events[1].new_capacity == 15 && events[1].elements_relocated == 5);
+        assert(std::strcmp(events[2].operation, "Assign") == 0 && events[2].location.line() == assign_line);
+        assert(events[2].new_capacity == 100 && events[2].elements_relocated == 0);
+        assert(std::strcmp(events[3].operation, "Insert") == 0 && events[3].location.line() == input_line);
+        assert(events[3].old_capacity == 100 && events[3].elements_relocated == 100);
+
+        // Копирующее присваивание в вектор меньшей вместимости тоже растит буфер
+        TracedVector bigger;
+        bigger.Resize(500);
+        trace.Clear();
+        v = bigger;
+        assert(trace.Size() == 1 && std::strcmp(trace.Events()[0].operation, "Assign") == 0);
+        assert(trace.Events()[0].new_capacity == 500 && v.Size() == 500);
+        // Оператор не знает места вызова и не приписывает рост vector.h
+        assert(trace.Events()[0].location.line() == 0 && *trace.Events()[0].location.file_name() == '\0');
+    }
+    {
+        // При переполнении кольца остаются последние kCapacity событий
+        trace.Clear();
+        for (size_t i = 0; i < GrowthTrace::kCapacity + 10; ++i) {
+            TracedVector v;
+            v.Reserve(i + 1);
+        }
+        assert(trace.Size() == GrowthTrace::kCapacity && trace.Dropped() == 10);
+        const Vector<GrowthEvent> events = trace.Events();
+        assert(events[0].new_capacity == 11 && events[events.Size() - 1].new_capacity == GrowthTrace::kCapacity + 10);
+    }
+    {
+        // Дамп в формате Chrome Trace Event
+        trace.Clear();
+        TracedVector v;
+        v.Reserve(16);
+        std::ostringstream json;
+        trace.WriteChromeTrace(json);
+        const std::string text = json.str();
+        assert(text.starts_with("{\"traceEvents\":["));
+        assert(text.find("\"name\":\"Reserve\"") != std::string::npos);
+        assert(text.find("\"ph\":\"X\"") != std::string::npos);
+        assert(text.find("\"new_capacity\":16") != std::string::npos);
+        assert(text.find("\"bytes\":64") != std::string::npos);
+        assert(text.find("main.cpp") != std::string::npos);
+        assert(text.ends_with("]}\n"));
+
+        trace.Clear();
+        std::ostringstream empty;
+        trace.WriteChromeTrace(empty);
+        assert(empty.str() == "{\"traceEvents\":[\n]}\n");
+    }
+    {
+        // Каждый поток пишет в свой буфер
+        trace.Clear();
+        size_t other_thread_events = 0;
+        std::thread worker([&other_thread_events] {
+            TracedVector v;
+            v.Reserve(8);
+            v.Resize(100);
+            other_thread_events = GrowthTrace::ThisThread().Size();
+        });
+        worker.join();
+        assert(other_thread_events == 2 && trace.Size() == 0);
+    }
+    {
+        // Общий дамп собирает буферы всех потоков, в том числе завершившихся
+        GrowthTrace::ClearAllThreads();
+        TracedVector v;
+        v.Reserve(1);
+        Vector<std::thread> workers;
+        for (size_t t = 0; t < 3; ++t) {
+            workers.EmplaceBack([t] {
+                TracedVector local;
+                local.Reserve(1000 + t);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::ostringstream json;
+        GrowthTrace::WriteChromeTraceAllThreads(json);
+        const std::string text = json.str();
+        for (const char* capacity : {"\"new_capacity\":1,", "\"new_capacity\":1000,", "\"new_capacity\":1001,",
+                                     "\"new_capacity\":1002,"}) {
+            assert(text.find(capacity) != std::string::npos);
+        }
+        size_t events = 0;
+        for (size_t pos = text.find("\"ph\":\"X\""); pos != std::string::npos; pos = text.find("\"ph\":\"X\"", pos + 1)) {
+            ++events;
+        }
+        assert(events == 4);
+
+        GrowthTrace::ClearAllThreads();
+        std::ostringstream empty;
+        GrowthTrace::WriteChromeTraceAllThreads(empty);
+        assert(empty.str() == "{\"traceEvents\":[\n]}\n" && trace.Size() == 0);
+    }
+    trace.Clear();
+}
+
 int main() {
     try {
         Test1();
@@ -387,6 +2636,39 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+#ifdef ADVANCED_VECTOR_HAS_MMAP
+        Test20();
+#endif
+        Test21();
+#ifdef ADVANCED_VECTOR_HAS_LARGE_PAGES
+        Test22();
+#endif
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
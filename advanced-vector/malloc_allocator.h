@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Аллокатор поверх malloc/realloc/free. Через reallocate вектор тривиально
+// перемещаемых элементов растёт вызовом realloc, который часто расширяет блок на месте
+// или переносит его средствами ядра (mremap) без копирования содержимого
+template <typename T>
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not support over-aligned types");
+
+public:
+    using value_type = T;
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = std::malloc(n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t /*n*/) noexcept {
+        std::free(ptr);
+    }
+
+    T* reallocate(T* ptr, size_t /*old_n*/, size_t new_n) noexcept {
+        if (new_n > static_cast<size_t>(-1) / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::realloc(ptr, new_n * sizeof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
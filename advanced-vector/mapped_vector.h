@@ -0,0 +1,365 @@
+#pragma once
+
+#include "vector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#define ADVANCED_VECTOR_HAS_MMAP 1
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+enum class MapMode {
+    // Изменения и рост пишутся в файл
+    kShared,
+    // Копирование при записи: файл не меняется, при росте элементы переезжают в кучу
+    kPrivate,
+};
+
+namespace mapped_vector_detail {
+
+// Заголовок файла. Элементы начинаются сразу за ним, с выравниванием элемента
+struct FileHeader {
+    static constexpr uint64_t kMagic = 0x524f544345564441;  // "ADVECTOR"
+    static constexpr uint32_t kVersion = 1;
+
+    uint64_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t element_size = 0;
+    uint64_t count = 0;
+};
+
+[[noreturn]] inline void ThrowSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Файл и его единственное отображение в память. Отображение отдаётся вектору
+// через MappedFileAllocator и освобождается им же
+class MappedFile {
+public:
+    MappedFile(const std::string& path, MapMode mode, size_t element_size, size_t alignment)
+        : mode_(mode)
+        , element_size_(element_size)
+        , data_offset_((sizeof(FileHeader) + alignment - 1) / alignment * alignment) {
+        fd_ = ::open(path.c_str(), mode == MapMode::kShared ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open " + path);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        assert(base_ == nullptr);
+        ::close(fd_);
+    }
+
+    [[nodiscard]] bool IsShared() const noexcept {
+        return mode_ == MapMode::kShared;
+    }
+
+    [[nodiscard]] bool IsMapped() const noexcept {
+        return base_ != nullptr;
+    }
+
+    [[nodiscard]] bool Owns(const void* ptr) const noexcept {
+        return base_ != nullptr && ptr == Data();
+    }
+
+    // Отображает уже записанный файл целиком. Возвращает число сохранённых элементов,
+    // capacity получает число элементов, помещающихся в файл
+    size_t MapExisting(void*& data, size_t& capacity) {
+        assert(!IsMapped());
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            ThrowSystemError("fstat");
+        }
+        const auto file_size = static_cast<size_t>(st.st_size);
+        if (file_size == 0) {
+            data = nullptr;
+            capacity = 0;
+            return 0;
+        }
+        has_header_ = true;
+        FileHeader header;
+        if (file_size < data_offset_ || ::pread(fd_, &header, sizeof(header), 0) != sizeof(header)) {
+            throw std::runtime_error("mapped vector file is truncated");
+        }
+        if (header.magic != FileHeader::kMagic || header.version != FileHeader::kVersion
+            || header.element_size != element_size_) {
+            throw std::runtime_error("mapped vector file has an incompatible format");
+        }
+        capacity = (file_size - data_offset_) / element_size_;
+        if (header.count > capacity) {
+            throw std::runtime_error("mapped vector file is truncated");
+        }
+        MapBytes(data_offset_ + capacity * element_size_);
+        data = Data();
+        return static_cast<size_t>(header.count);
+    }
+
+    // Отводит под вектор файл заново, прежнее содержимое теряется
+    void* Map(size_t capacity) {
+        assert(IsShared() && !IsMapped());
+        const size_t bytes = data_offset_ + capacity * element_size_;
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            throw std::bad_alloc();
+        }
+        MapBytes(bytes);
+        FileHeader header;
+        header.element_size = static_cast<uint32_t>(element_size_);
+        *static_cast<FileHeader*>(base_) = header;
+        has_header_ = true;
+        return Data();
+    }
+
+    // Меняет длину файла и отображения. Возвращает nullptr, если это не удалось:
+    // тогда прежнее отображение остаётся в силе
+    void* Remap(size_t capacity) noexcept {
+        if (!IsShared()) {
+            return nullptr;
+        }
+        const size_t bytes = data_offset_ + capacity * element_size_;
+        if (bytes > mapped_bytes_ && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            return nullptr;
+        }
+#if defined(__linux__)
+        void* base = ::mremap(base_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (base == MAP_FAILED) {
+            return nullptr;
+        }
+#else
+        // Второе разделяемое отображение видит те же страницы файла
+        void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) {
+            return nullptr;
+        }
+        ::munmap(base_, mapped_bytes_);
+#endif
+        if (bytes < mapped_bytes_) {
+            // Ошибка здесь оставит лишь неиспользуемый хвост файла
+            [[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(bytes));
+        }
+        base_ = base;
+        mapped_bytes_ = bytes;
+        return Data();
+    }
+
+    void Unmap() noexcept {
+        assert(IsMapped());
+        ::munmap(base_, mapped_bytes_);
+        base_ = nullptr;
+        mapped_bytes_ = 0;
+    }
+
+    // Записывает число элементов в заголовок и сбрасывает отображение на диск. Без отображения
+    // (вектор освободил буфер) заголовок обновляется записью в файл, иначе при следующем
+    // открытии вернулись бы удалённые элементы
+    void Flush(size_t count) {
+        if (!IsShared() || !has_header_) {
+            return;
+        }
+        if (IsMapped()) {
+            static_cast<FileHeader*>(base_)->count = count;
+            if (::msync(base_, mapped_bytes_, MS_SYNC) != 0) {
+                ThrowSystemError("msync");
+            }
+            return;
+        }
+        const uint64_t stored_count = count;
+        if (::pwrite(fd_, &stored_count, sizeof(stored_count), offsetof(FileHeader, count))
+            != static_cast<ssize_t>(sizeof(stored_count))) {
+            ThrowSystemError("pwrite");
+        }
+        if (::fsync(fd_) != 0) {
+            ThrowSystemError("fsync");
+        }
+    }
+
+private:
+    int fd_ = -1;
+    MapMode mode_;
+    size_t element_size_;
+    size_t data_offset_;
+    void* base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    // В файле уже записан заголовок
+    bool has_header_ = false;
+
+    void* Data() const noexcept {
+        return static_cast<char*>(base_) + data_offset_;
+    }
+
+    void MapBytes(size_t bytes) {
+        const int flags = IsShared() ? MAP_SHARED : MAP_PRIVATE;
+        void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd_, 0);
+        if (base == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        base_ = base;
+        mapped_bytes_ = bytes;
+    }
+};
+
+}  // namespace mapped_vector_detail
+
+// Отдаёт вектору отображение файла, пока оно свободно. Рост идёт через reallocate:
+// ftruncate и mremap без копирования элементов. Если отображение занято, в режиме kPrivate
+// память берётся из кучи, а в режиме kShared выделение завершается std::bad_alloc, чтобы
+// данные не ушли из файла незаметно. Аллокатор без файла работает только с кучей
+template <typename T>
+class MappedFileAllocator {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects can live in a file");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not support over-aligned types");
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    MappedFileAllocator() = default;
+
+    explicit MappedFileAllocator(std::shared_ptr<mapped_vector_detail::MappedFile> file) noexcept
+        : file_(std::move(file)) {
+    }
+
+    // Копия вектора не должна попадать в файл оригинала
+    MappedFileAllocator select_on_container_copy_construction() const noexcept {
+        return MappedFileAllocator();
+    }
+
+    T* allocate(size_t n) {
+        if (file_ != nullptr && file_->IsShared()) {
+            if (file_->IsMapped()) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(file_->Map(n));
+        }
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = std::malloc(n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t /*n*/) noexcept {
+        if (IsMapped(ptr)) {
+            file_->Unmap();
+        }
+        else {
+            std::free(ptr);
+        }
+    }
+
+    T* reallocate(T* ptr, size_t /*old_n*/, size_t new_n) noexcept {
+        if (IsMapped(ptr)) {
+            return static_cast<T*>(file_->Remap(new_n));
+        }
+        if (new_n > static_cast<size_t>(-1) / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::realloc(ptr, new_n * sizeof(T)));
+    }
+
+    bool IsMapped(const T* ptr) const noexcept {
+        return file_ != nullptr && file_->Owns(ptr);
+    }
+
+    const std::shared_ptr<mapped_vector_detail::MappedFile>& GetFile() const noexcept {
+        return file_;
+    }
+
+    bool operator==(const MappedFileAllocator& other) const noexcept {
+        return file_ == other.file_;
+    }
+
+    bool operator!=(const MappedFileAllocator& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    std::shared_ptr<mapped_vector_detail::MappedFile> file_;
+};
+
+// Вектор поверх файла. Открытие существующего файла — это одно отображение без чтения
+// и копирования элементов. Число элементов хранится в заголовке и записывается Flush
+// и деструктором; без Flush после изменений файл после сбоя может содержать старый размер
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+class MappedVector : public Vector<T, MappedFileAllocator<T>, GrowthPolicy> {
+    using Allocator = MappedFileAllocator<T>;
+    using Base = Vector<T, Allocator, GrowthPolicy>;
+
+public:
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::kShared)
+        : MappedVector(Open(path, mode)) {
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept = default;
+
+    ~MappedVector() {
+        try {
+            Flush();
+        }
+        catch (...) {
+            // Деструктор не бросает; кому важна ошибка msync, вызывает Flush явно
+        }
+    }
+
+    // Сохраняет размер в заголовке и синхронно пишет изменённые страницы на диск.
+    // Размер записывается и после того, как ShrinkToFit или ReleaseStorage отпустили файл.
+    // В режиме kPrivate ничего не делает
+    void Flush() {
+        const Allocator alloc = Base::GetAllocator();
+        if (alloc.GetFile() != nullptr) {
+            alloc.GetFile()->Flush(Base::Size());
+        }
+    }
+
+    // Элементы лежат в отображении файла
+    [[nodiscard]] bool IsFileBacked() const noexcept {
+        return Base::Capacity() != 0 && Base::GetAllocator().IsMapped(Base::begin());
+    }
+
+private:
+    struct OpenedFile {
+        RawMemory<T, Allocator> storage;
+        size_t count = 0;
+    };
+
+    explicit MappedVector(OpenedFile&& opened) noexcept
+        : Base(std::move(opened.storage), opened.count) {
+    }
+
+    static OpenedFile Open(const std::string& path, MapMode mode) {
+        Allocator alloc(std::make_shared<mapped_vector_detail::MappedFile>(path, mode, sizeof(T), alignof(T)));
+        void* data = nullptr;
+        size_t capacity = 0;
+        const size_t count = alloc.GetFile()->MapExisting(data, capacity);
+        return OpenedFile{RawMemory<T, Allocator>(static_cast<T*>(data), capacity, alloc), count};
+    }
+};
+
+#endif
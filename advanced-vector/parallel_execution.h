@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+// Политика параллельного выполнения массовых операций над элементами: создания, копирования,
+// переноса и разрушения. Диапазон делится на куски не мельче min_elements_per_thread, каждый
+// кусок обрабатывает свой поток, первый — вызывающий. Короткие диапазоны выполняются
+// в одном потоке без запуска новых
+struct ParallelExecution {
+    // 0 — по числу аппаратных потоков
+    size_t max_threads = 0;
+    size_t min_elements_per_thread = 1 << 14;
+
+    [[nodiscard]] size_t ThreadCount(size_t n) const noexcept {
+        size_t threads = max_threads != 0 ? max_threads : std::thread::hardware_concurrency();
+        threads = std::max<size_t>(threads, 1);
+        const size_t min_chunk = std::max<size_t>(min_elements_per_thread, 1);
+        return std::max<size_t>(std::min(threads, n / min_chunk), 1);
+    }
+};
+
+namespace parallel_detail {
+
+// Выполняет operation(first, count) над кусками [0, n). Если какие-то куски завершились
+// исключением, для каждого успешного вызывается rollback(first, count), а затем
+// выбрасывается первое исключение. Неудачный кусок сам отвечает за свою частичную работу
+template <typename Operation, typename Rollback>
+void ForEachChunk(size_t n, const ParallelExecution& policy, Operation operation, Rollback rollback) {
+    const size_t chunks = policy.ThreadCount(n);
+    if (chunks == 1) {
+        operation(size_t(0), n);
+        return;
+    }
+    auto chunk_first = [n, chunks](size_t chunk) {
+        return n / chunks * chunk + std::min(chunk, n % chunks);
+    };
+    auto errors = std::make_unique<std::exception_ptr[]>(chunks);
+    auto run = [&](size_t chunk) noexcept {
+        try {
+            operation(chunk_first(chunk), chunk_first(chunk + 1) - chunk_first(chunk));
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    {
+        auto threads = std::make_unique<std::thread[]>(chunks);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            try {
+                threads[chunk] = std::thread(run, chunk);
+            }
+            catch (...) {
+                // Поток не запустился — выполняем кусок сами
+                run(chunk);
+            }
+        }
+        run(0);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            if (threads[chunk].joinable()) {
+                threads[chunk].join();
+            }
+        }
+    }
+    std::exception_ptr first_error;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        if (errors[chunk] && !first_error) {
+            first_error = errors[chunk];
+        }
+    }
+    if (first_error) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (!errors[chunk]) {
+                rollback(chunk_first(chunk), chunk_first(chunk + 1) - chunk_first(chunk));
+            }
+        }
+        std::rethrow_exception(first_error);
+    }
+}
+
+template <typename Operation>
+void ForEachChunk(size_t n, const ParallelExecution& policy, Operation operation) {
+    ForEachChunk(n, policy, operation, [](size_t, size_t) noexcept {
+    });
+}
+
+// Параллельные аналоги алгоритмов из <memory> со строгой гарантией: при исключении все
+// созданные объекты разрушаются
+
+template <typename T>
+void UninitializedValueConstructN(T* dst, size_t n, const ParallelExecution& policy) {
+    ForEachChunk(
+        n, policy,
+        [dst](size_t first, size_t count) {
+            std::uninitialized_value_construct_n(dst + first, count);
+        },
+        [dst](size_t first, size_t count) noexcept {
+            std::destroy_n(dst + first, count);
+        });
+}
+
+template <typename T>
+void UninitializedCopyN(const T* src, size_t n, T* dst, const ParallelExecution& policy) {
+    ForEachChunk(
+        n, policy,
+        [src, dst](size_t first, size_t count) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                if (count != 0) {
+                    std::memcpy(static_cast<void*>(dst + first), static_cast<const void*>(src + first),
+                                count * sizeof(T));
+                }
+            }
+            else {
+                std::uninitialized_copy_n(src + first, count, dst + first);
+            }
+        },
+        [dst](size_t first, size_t count) noexcept {
+            std::destroy_n(dst + first, count);
+        });
+}
+
+template <typename T>
+void DestroyN(T* first, size_t n, const ParallelExecution& policy) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        // Разрушение не бросает, поэтому исключение возможно только при подготовке потоков,
+        // до того как разрушен хоть один элемент
+        try {
+            ForEachChunk(n, policy, [first](size_t offset, size_t count) noexcept {
+                std::destroy_n(first + offset, count);
+            });
+        }
+        catch (...) {
+            std::destroy_n(first, n);
+        }
+    }
+}
+
+}  // namespace parallel_detail
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace prefetch_detail {
+
+// Как далеко вперёд по умолчанию заглядывают обходы: несколько промахов кэша успевают
+// обслуживаться одновременно, пока обрабатываются текущие элементы
+inline constexpr size_t kDefaultDistance = 8;
+
+// Подсказка процессору загрузить строку кэша для чтения. Подсказка не разыменовывает адрес,
+// поэтому нулевой и висящий указатели безопасны
+inline void Prefetch(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+// Для вектора указателей заранее загружается объект, на который указывает элемент:
+// сами указатели лежат подряд и их подтягивает аппаратный префетчер
+template <typename T>
+inline void PrefetchElement(const T& element) noexcept {
+    if constexpr (std::is_pointer_v<T>) {
+        Prefetch(element);
+    }
+    else {
+        Prefetch(&element);
+    }
+}
+
+template <typename T, typename Fn>
+void ForEachPrefetched(T* data, size_t size, size_t distance, Fn& fn) {
+    size_t index = 0;
+    // Основной цикл без проверки границы упреждения; хвост короче distance идёт без подсказок
+    for (; index + distance < size; ++index) {
+        PrefetchElement(data[index + distance]);
+        fn(data[index]);
+    }
+    for (; index < size; ++index) {
+        fn(data[index]);
+    }
+}
+
+}  // namespace prefetch_detail
+
+// Итератор по непрерывному диапазону, который при каждом шаге подсказывает загрузку
+// элемента на distance позиций вперёд (для указателей — объекта, на который тот указывает).
+// Граница end нужна, чтобы не заглядывать за конец диапазона
+template <typename T>
+class PrefetchingIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    PrefetchingIterator() = default;
+
+    PrefetchingIterator(T* current, T* end, size_t distance) noexcept
+        : current_(current)
+        , end_(end)
+        , distance_(distance) {
+        PrefetchAhead();
+    }
+
+    reference operator*() const noexcept {
+        return *current_;
+    }
+
+    pointer operator->() const noexcept {
+        return current_;
+    }
+
+    PrefetchingIterator& operator++() noexcept {
+        ++current_;
+        PrefetchAhead();
+        return *this;
+    }
+
+    PrefetchingIterator operator++(int) noexcept {
+        PrefetchingIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    bool operator==(const PrefetchingIterator& other) const noexcept {
+        return current_ == other.current_;
+    }
+
+private:
+    T* current_ = nullptr;
+    T* end_ = nullptr;
+    size_t distance_ = 0;
+
+    void PrefetchAhead() const noexcept {
+        if (static_cast<size_t>(end_ - current_) > distance_) {
+            prefetch_detail::PrefetchElement(current_[distance_]);
+        }
+    }
+};
+
+// Диапазон для range-for поверх PrefetchingIterator
+template <typename T>
+class PrefetchedRange {
+public:
+    PrefetchedRange(T* first, T* last, size_t distance) noexcept
+        : first_(first)
+        , last_(last)
+        , distance_(distance) {
+    }
+
+    PrefetchingIterator<T> begin() const noexcept {
+        return {first_, last_, distance_};
+    }
+
+    PrefetchingIterator<T> end() const noexcept {
+        return {last_, last_, distance_};
+    }
+
+private:
+    T* first_;
+    T* last_;
+    size_t distance_;
+};
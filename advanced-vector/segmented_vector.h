@@ -0,0 +1,361 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace segmented_vector_detail {
+
+// Размер блока по умолчанию: около 4 КиБ, округлённые вниз до степени двойки элементов
+template <typename T>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t chunk_size = 1;
+    while (chunk_size * 2 * sizeof(T) <= 4096) {
+        chunk_size *= 2;
+    }
+    return chunk_size;
+}
+
+constexpr size_t Log2(size_t value) noexcept {
+    size_t result = 0;
+    while (value > 1) {
+        value /= 2;
+        ++result;
+    }
+    return result;
+}
+
+}  // namespace segmented_vector_detail
+
+// Вектор из блоков фиксированного размера ChunkSize. При росте добавляется новый блок,
+// а уже созданные элементы не переезжают: ссылки и указатели на них остаются валидными
+// до удаления самого элемента. Итераторы хранят адрес контейнера и индекс, поэтому
+// вставка в конец их тоже не портит (кроме end()). Переезжает только небольшой индекс блоков
+template <typename T, size_t ChunkSize = segmented_vector_detail::DefaultChunkSize<T>(),
+          typename Allocator = std::allocator<T>>
+class SegmentedVector {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    using Chunk = RawMemory<T, Allocator>;
+    using ChunkAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>;
+
+    static constexpr size_t kChunkShift = segmented_vector_detail::Log2(ChunkSize);
+    static constexpr size_t kChunkMask = ChunkSize - 1;
+
+    template <typename Container, typename Value>
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Value>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator() = default;
+
+        Iterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherContainer, typename OtherValue,
+                  std::enable_if_t<std::is_convertible_v<OtherValue*, Value*>, int> = 0>
+        Iterator(const Iterator<OtherContainer, OtherValue>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*container_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*container_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*container_)[index_ + offset];
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend Iterator operator+(difference_type offset, Iterator it) noexcept {
+            return it += offset;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.container_ == rhs.container_);
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.container_ == rhs.container_);
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs - rhs < 0;
+        }
+
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        template <typename, typename>
+        friend class Iterator;
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using iterator = Iterator<SegmentedVector, T>;
+    using const_iterator = Iterator<const SegmentedVector, const T>;
+    using allocator_type = Allocator;
+
+    static constexpr size_t kChunkSize = ChunkSize;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator& alloc)
+        : chunks_(ChunkAllocator(alloc))
+        , alloc_(alloc) {
+    }
+
+    explicit SegmentedVector(size_t size, const Allocator& alloc = Allocator())
+        : SegmentedVector(alloc) {
+        Resize(size);
+    }
+
+    SegmentedVector(std::initializer_list<T> init, const Allocator& alloc = Allocator())
+        : SegmentedVector(alloc) {
+        Reserve(init.size());
+        for (const T& value : init) {
+            EmplaceBack(value);
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc_)) {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    // Блоки переходят к новому вектору целиком, элементы не перемещаются
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : chunks_(std::move(other.chunks_))
+        , alloc_(other.alloc_)
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            chunks_ = std::move(rhs.chunks_);
+            alloc_ = rhs.alloc_;
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        chunks_.Swap(other.chunks_);
+        std::swap(alloc_, other.alloc_);
+        std::swap(size_, other.size_);
+    }
+
+    // Заранее выделяет блоки под capacity элементов; существующие элементы не трогает
+    void Reserve(size_t capacity) {
+        const size_t chunk_count = (capacity + kChunkMask) >> kChunkShift;
+        chunks_.Reserve(chunk_count);
+        while (chunks_.Size() < chunk_count) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            while (size_ > new_size) {
+                PopBack();
+            }
+        }
+        else {
+            Reserve(new_size);
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+        }
+    }
+
+    template <typename T1>
+    void PushBack(T1&& value) {
+        EmplaceBack(std::forward<T1>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+        T* slot = Slot(size_);
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(size_);
+        --size_;
+        std::destroy_at(Slot(size_));
+    }
+
+    // Разрушает элементы, но оставляет выделенные блоки для повторного заполнения
+    void Clear() noexcept {
+        for (size_t chunk = 0; size_ > 0; ++chunk) {
+            const size_t count = size_ < ChunkSize ? size_ : ChunkSize;
+            std::destroy_n(chunks_[chunk].GetAddress(), count);
+            size_ -= count;
+        }
+    }
+
+    // Освобождает блоки, оставшиеся без элементов
+    void ShrinkToFit() {
+        const size_t chunk_count = (size_ + kChunkMask) >> kChunkShift;
+        while (chunks_.Size() > chunk_count) {
+            chunks_.PopBack();
+        }
+        chunks_.ShrinkToFit();
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        return chunks_.Size() * ChunkSize;
+    }
+
+    [[nodiscard]] size_t ChunkCount() const noexcept {
+        return chunks_.Size();
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+private:
+    Vector<Chunk, ChunkAllocator> chunks_;
+    [[no_unique_address]] Allocator alloc_;
+    size_t size_ = 0;
+
+    T* Slot(size_t index) noexcept {
+        return chunks_[index >> kChunkShift] + (index & kChunkMask);
+    }
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+#endif
+
+// Двоичный формат вектора тривиально копируемых элементов: заголовок SerializedHeader,
+// за ним count * element_size байт элементов в порядке байтов записавшей машины.
+// Машина с другим порядком байтов не узнает magic и откажется читать данные
+struct SerializedHeader {
+    static constexpr uint32_t kMagic = 0x56454356;  // "VCEV"
+    static constexpr uint16_t kVersion = 1;
+
+    uint32_t magic = kMagic;
+    uint16_t version = kVersion;
+    uint16_t header_size = sizeof(SerializedHeader);
+    uint32_t element_size = 0;
+    uint32_t element_alignment = 0;
+    uint64_t count = 0;
+    uint64_t checksum = 0;
+};
+
+static_assert(sizeof(SerializedHeader) == 32, "the header layout is part of the format");
+
+// 64-битный FNV-1a. seed позволяет считать сумму по частям
+inline uint64_t Fnv1a(std::span<const std::byte> bytes, uint64_t seed = 0xcbf29ce484222325) noexcept {
+    uint64_t hash = seed;
+    for (std::byte byte : bytes) {
+        hash ^= static_cast<uint64_t>(byte);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+template <typename T>
+SerializedHeader MakeSerializedHeader(std::span<const T> elements) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects can be serialized");
+    SerializedHeader header;
+    header.element_size = sizeof(T);
+    header.element_alignment = alignof(T);
+    header.count = elements.size();
+    header.checksum = Fnv1a(std::as_bytes(elements));
+    return header;
+}
+
+// Проверяет, что заголовок описывает элементы типа T. Контрольная сумма проверяется
+// после чтения элементов функцией VerifyChecksum
+template <typename T>
+void ValidateSerializedHeader(const SerializedHeader& header) {
+    if (header.magic != SerializedHeader::kMagic || header.header_size != sizeof(SerializedHeader)) {
+        throw std::runtime_error("not a serialized vector");
+    }
+    if (header.version != SerializedHeader::kVersion) {
+        throw std::runtime_error("unsupported serialized vector version");
+    }
+    if (header.element_size != sizeof(T) || header.element_alignment != alignof(T)) {
+        throw std::runtime_error("serialized vector has a different element type");
+    }
+}
+
+inline void VerifyChecksum(const SerializedHeader& header, std::span<const std::byte> bytes) {
+    if (Fnv1a(bytes) != header.checksum) {
+        throw std::runtime_error("serialized vector checksum mismatch");
+    }
+}
+
+namespace serialization_detail {
+
+// Порция чтения элементов. Число элементов в заголовке не проверено, поэтому вектор
+// растёт только по мере прихода данных: испорченный заголовок не вызовет огромного выделения
+// до того, как поток закончится
+inline constexpr size_t kReadChunkBytes = size_t(1) << 20;
+
+// read(data, size) читает ровно size байт или бросает исключение
+template <typename Vec, typename Read>
+void ReadElements(Vec& v, uint64_t count, Read read) {
+    using T = typename Vec::value_type;
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::runtime_error("serialized vector is too large");
+    }
+    const auto total = static_cast<size_t>(count);
+    const size_t chunk = std::max<size_t>(1, kReadChunkBytes / sizeof(T));
+    while (v.Size() < total) {
+        const size_t step = std::min(chunk, total - v.Size());
+        T* dst = v.GrowBy(step);
+        read(static_cast<void*>(dst), step * sizeof(T));
+    }
+}
+
+}  // namespace serialization_detail
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename StatsPolicy>
+void Serialize(std::ostream& out, const Vector<T, Allocator, GrowthPolicy, StatsPolicy>& v) {
+    const SerializedHeader header = MakeSerializedHeader(std::span<const T>(v.begin(), v.Size()));
+    const auto bytes = v.AsBytes();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+        throw std::runtime_error("failed to write serialized vector");
+    }
+}
+
+// Читает элементы сразу в буфер вектора, без нулевой инициализации и промежуточного буфера
+template <typename Vec>
+Vec Deserialize(std::istream& in) {
+    using T = typename Vec::value_type;
+    SerializedHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("failed to read serialized vector header");
+    }
+    ValidateSerializedHeader<T>(header);
+    Vec v;
+    serialization_detail::ReadElements(v, header.count, [&in](void* data, size_t size) {
+        if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error("serialized vector is truncated");
+        }
+    });
+    VerifyChecksum(header, v.AsBytes());
+    return v;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+namespace serialization_detail {
+
+// Дописывает iov целиком, повторяя writev после частичной записи
+inline void WriteAll(int fd, iovec* iov, int count) {
+    while (count > 0) {
+        const ssize_t written = ::writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        auto left = static_cast<size_t>(written);
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+inline void ReadAll(int fd, void* data, size_t size) {
+    auto* dst = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t received = ::read(fd, dst, size);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (received == 0) {
+            throw std::runtime_error("serialized vector is truncated");
+        }
+        dst += received;
+        size -= static_cast<size_t>(received);
+    }
+}
+
+}  // namespace serialization_detail
+
+// Записывает заголовок и элементы одним writev прямо из буфера вектора
+template <typename T, typename Allocator, typename GrowthPolicy, typename StatsPolicy>
+void WriteVector(int fd, const Vector<T, Allocator, GrowthPolicy, StatsPolicy>& v) {
+    SerializedHeader header = MakeSerializedHeader(std::span<const T>(v.begin(), v.Size()));
+    const auto bytes = v.AsBytes();
+    iovec iov[2] = {
+        {&header, sizeof(header)},
+        {const_cast<std::byte*>(bytes.data()), bytes.size()},
+    };
+    serialization_detail::WriteAll(fd, iov, bytes.empty() ? 1 : 2);
+}
+
+template <typename Vec>
+Vec ReadVector(int fd) {
+    using T = typename Vec::value_type;
+    SerializedHeader header;
+    serialization_detail::ReadAll(fd, &header, sizeof(header));
+    ValidateSerializedHeader<T>(header);
+    Vec v;
+    serialization_detail::ReadElements(v, header.count, [fd](void* data, size_t size) {
+        serialization_detail::ReadAll(fd, data, size);
+    });
+    VerifyChecksum(header, v.AsBytes());
+    return v;
+}
+
+#endif
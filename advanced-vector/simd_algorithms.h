@@ -0,0 +1,539 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) && defined(__SSE2__)
+#define ADVANCED_VECTOR_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#define ADVANCED_VECTOR_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__)
+#define ADVANCED_VECTOR_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Тип сравнивается на равенство побайтово: a == b тогда и только тогда, когда совпадают
+// их объектные представления. Тогда поиск и сравнение векторов идут через memchr, memcmp
+// и целочисленные SIMD-ядра. Для структур без заполнителей с почленным operator== признак
+// можно включить специализацией
+template <typename T>
+struct IsTriviallyComparable
+    : std::bool_constant<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>> {
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyComparableV = IsTriviallyComparable<T>::value;
+
+namespace simd_detail {
+
+inline unsigned CountTrailingZeros(unsigned mask) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned result = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++result;
+    }
+    return result;
+#endif
+}
+
+inline unsigned PopCount(unsigned mask) noexcept {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#else
+    unsigned result = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+// Элементы ядер читаются через memcpy: целочисленные ядра работают и с перечислениями
+// и указателями, не нарушая правил алиасинга
+template <typename Lane>
+Lane LoadLane(const Lane* ptr) noexcept {
+    Lane lane;
+    std::memcpy(&lane, ptr, sizeof(Lane));
+    return lane;
+}
+
+// Каждое ядро описывается набором операций Ops над блоком из Ops::kLanes элементов:
+// маска с битом на элемент, равный value, и маска совпадающих элементов двух блоков.
+// Макрос определяет общие циклы для набора операций с нужным атрибутом target
+#define ADVANCED_VECTOR_DEFINE_KERNELS(Suffix, Ops, Target)                                        \
+    template <typename Lane>                                                                      \
+    Target size_t Find##Suffix(const Lane* data, size_t n, Lane value) noexcept {                 \
+        using LaneOps = Ops<Lane>;                                                                \
+        const auto splat = LaneOps::Splat(value);                                                 \
+        size_t i = 0;                                                                             \
+        for (; i + LaneOps::kLanes <= n; i += LaneOps::kLanes) {                                  \
+            if (const unsigned mask = LaneOps::EqualMask(data + i, splat)) {                      \
+                return i + CountTrailingZeros(mask);                                              \
+            }                                                                                     \
+        }                                                                                         \
+        for (; i < n; ++i) {                                                                      \
+            if (LoadLane(data + i) == value) {                                                    \
+                return i;                                                                         \
+            }                                                                                     \
+        }                                                                                         \
+        return n;                                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    template <typename Lane>                                                                      \
+    Target size_t Count##Suffix(const Lane* data, size_t n, Lane value) noexcept {                \
+        using LaneOps = Ops<Lane>;                                                                \
+        const auto splat = LaneOps::Splat(value);                                                 \
+        size_t count = 0;                                                                         \
+        size_t i = 0;                                                                             \
+        for (; i + LaneOps::kLanes <= n; i += LaneOps::kLanes) {                                  \
+            count += PopCount(LaneOps::EqualMask(data + i, splat));                               \
+        }                                                                                         \
+        for (; i < n; ++i) {                                                                      \
+            count += LoadLane(data + i) == value;                                                 \
+        }                                                                                         \
+        return count;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    template <typename Lane>                                                                      \
+    Target size_t Mismatch##Suffix(const Lane* lhs, const Lane* rhs, size_t n) noexcept {         \
+        using LaneOps = Ops<Lane>;                                                                \
+        constexpr unsigned kAllEqual = (1u << LaneOps::kLanes) - 1;                               \
+        size_t i = 0;                                                                             \
+        for (; i + LaneOps::kLanes <= n; i += LaneOps::kLanes) {                                  \
+            if (const unsigned mask = LaneOps::EqualMask(lhs + i, rhs + i); mask != kAllEqual) {  \
+                return i + CountTrailingZeros(~mask);                                             \
+            }                                                                                     \
+        }                                                                                         \
+        for (; i < n; ++i) {                                                                      \
+            if (!(LoadLane(lhs + i) == LoadLane(rhs + i))) {                                      \
+                return i;                                                                         \
+            }                                                                                     \
+        }                                                                                         \
+        return n;                                                                                 \
+    }
+
+#if defined(ADVANCED_VECTOR_SIMD_SSE2)
+
+template <typename Lane>
+struct Sse2Ops;
+
+template <>
+struct Sse2Ops<uint32_t> {
+    static constexpr size_t kLanes = 4;
+
+    static __m128i Splat(uint32_t value) noexcept {
+        return _mm_set1_epi32(static_cast<int>(value));
+    }
+
+    static unsigned EqualMask(const uint32_t* data, __m128i splat) noexcept {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, splat))));
+    }
+
+    static unsigned EqualMask(const uint32_t* lhs, const uint32_t* rhs) noexcept {
+        return EqualMask(lhs, _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs)));
+    }
+};
+
+template <>
+struct Sse2Ops<uint64_t> {
+    static constexpr size_t kLanes = 2;
+
+    static __m128i Splat(uint64_t value) noexcept {
+        return _mm_set1_epi64x(static_cast<long long>(value));
+    }
+
+    // В SSE2 нет сравнения 64-битных чисел: половины должны совпасть обе
+    static unsigned EqualMask(const uint64_t* data, __m128i splat) noexcept {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        const __m128i equal32 = _mm_cmpeq_epi32(block, splat);
+        const __m128i equal64 = _mm_and_si128(equal32, _mm_shuffle_epi32(equal32, _MM_SHUFFLE(2, 3, 0, 1)));
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(equal64)));
+    }
+
+    static unsigned EqualMask(const uint64_t* lhs, const uint64_t* rhs) noexcept {
+        return EqualMask(lhs, _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs)));
+    }
+};
+
+template <>
+struct Sse2Ops<float> {
+    static constexpr size_t kLanes = 4;
+
+    static __m128 Splat(float value) noexcept {
+        return _mm_set1_ps(value);
+    }
+
+    static unsigned EqualMask(const float* data, __m128 splat) noexcept {
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(data), splat)));
+    }
+
+    static unsigned EqualMask(const float* lhs, const float* rhs) noexcept {
+        return EqualMask(lhs, _mm_loadu_ps(rhs));
+    }
+};
+
+template <>
+struct Sse2Ops<double> {
+    static constexpr size_t kLanes = 2;
+
+    static __m128d Splat(double value) noexcept {
+        return _mm_set1_pd(value);
+    }
+
+    static unsigned EqualMask(const double* data, __m128d splat) noexcept {
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(data), splat)));
+    }
+
+    static unsigned EqualMask(const double* lhs, const double* rhs) noexcept {
+        return EqualMask(lhs, _mm_loadu_pd(rhs));
+    }
+};
+
+ADVANCED_VECTOR_DEFINE_KERNELS(Sse2, Sse2Ops, )
+
+#endif
+
+#if defined(ADVANCED_VECTOR_SIMD_AVX2)
+
+#define ADVANCED_VECTOR_TARGET_AVX2 __attribute__((target("avx2")))
+
+template <typename Lane>
+struct Avx2Ops;
+
+template <>
+struct Avx2Ops<uint32_t> {
+    static constexpr size_t kLanes = 8;
+
+    ADVANCED_VECTOR_TARGET_AVX2 static __m256i Splat(uint32_t value) noexcept {
+        return _mm256_set1_epi32(static_cast<int>(value));
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const uint32_t* data, __m256i splat) noexcept {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, splat))));
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const uint32_t* lhs, const uint32_t* rhs) noexcept {
+        return EqualMask(lhs, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs)));
+    }
+};
+
+template <>
+struct Avx2Ops<uint64_t> {
+    static constexpr size_t kLanes = 4;
+
+    ADVANCED_VECTOR_TARGET_AVX2 static __m256i Splat(uint64_t value) noexcept {
+        return _mm256_set1_epi64x(static_cast<long long>(value));
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const uint64_t* data, __m256i splat) noexcept {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(block, splat))));
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const uint64_t* lhs, const uint64_t* rhs) noexcept {
+        return EqualMask(lhs, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs)));
+    }
+};
+
+template <>
+struct Avx2Ops<float> {
+    static constexpr size_t kLanes = 8;
+
+    ADVANCED_VECTOR_TARGET_AVX2 static __m256 Splat(float value) noexcept {
+        return _mm256_set1_ps(value);
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const float* data, __m256 splat) noexcept {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data), splat, _CMP_EQ_OQ)));
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const float* lhs, const float* rhs) noexcept {
+        return EqualMask(lhs, _mm256_loadu_ps(rhs));
+    }
+};
+
+template <>
+struct Avx2Ops<double> {
+    static constexpr size_t kLanes = 4;
+
+    ADVANCED_VECTOR_TARGET_AVX2 static __m256d Splat(double value) noexcept {
+        return _mm256_set1_pd(value);
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const double* data, __m256d splat) noexcept {
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data), splat, _CMP_EQ_OQ)));
+    }
+
+    ADVANCED_VECTOR_TARGET_AVX2 static unsigned EqualMask(const double* lhs, const double* rhs) noexcept {
+        return EqualMask(lhs, _mm256_loadu_pd(rhs));
+    }
+};
+
+ADVANCED_VECTOR_DEFINE_KERNELS(Avx2, Avx2Ops, ADVANCED_VECTOR_TARGET_AVX2)
+
+// Проверка выполняется один раз; __builtin_cpu_supports учитывает и поддержку AVX в ОС
+inline bool HasAvx2() noexcept {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+#endif
+
+#if defined(ADVANCED_VECTOR_SIMD_NEON)
+
+template <typename Lane>
+struct NeonOps;
+
+// NEON не умеет собирать маску из старших битов, поэтому результат сравнения
+// сдвигается и сужается до маски с битом на элемент
+template <>
+struct NeonOps<uint32_t> {
+    static constexpr size_t kLanes = 4;
+
+    static uint32x4_t Splat(uint32_t value) noexcept {
+        return vdupq_n_u32(value);
+    }
+
+    static unsigned ToMask(uint32x4_t equal) noexcept {
+        static const int32_t kShifts[4] = {0, 1, 2, 3};
+        return vaddvq_u32(vshlq_u32(vshrq_n_u32(equal, 31), vld1q_s32(kShifts)));
+    }
+
+    static unsigned EqualMask(const uint32_t* data, uint32x4_t splat) noexcept {
+        return ToMask(vceqq_u32(vld1q_u32(data), splat));
+    }
+
+    static unsigned EqualMask(const uint32_t* lhs, const uint32_t* rhs) noexcept {
+        return EqualMask(lhs, vld1q_u32(rhs));
+    }
+};
+
+template <>
+struct NeonOps<uint64_t> {
+    static constexpr size_t kLanes = 2;
+
+    static uint64x2_t Splat(uint64_t value) noexcept {
+        return vdupq_n_u64(value);
+    }
+
+    static unsigned ToMask(uint64x2_t equal) noexcept {
+        return static_cast<unsigned>((vgetq_lane_u64(equal, 0) & 1) | (vgetq_lane_u64(equal, 1) & 2));
+    }
+
+    static unsigned EqualMask(const uint64_t* data, uint64x2_t splat) noexcept {
+        return ToMask(vceqq_u64(vld1q_u64(data), splat));
+    }
+
+    static unsigned EqualMask(const uint64_t* lhs, const uint64_t* rhs) noexcept {
+        return EqualMask(lhs, vld1q_u64(rhs));
+    }
+};
+
+template <>
+struct NeonOps<float> {
+    static constexpr size_t kLanes = 4;
+
+    static float32x4_t Splat(float value) noexcept {
+        return vdupq_n_f32(value);
+    }
+
+    static unsigned EqualMask(const float* data, float32x4_t splat) noexcept {
+        return NeonOps<uint32_t>::ToMask(vceqq_f32(vld1q_f32(data), splat));
+    }
+
+    static unsigned EqualMask(const float* lhs, const float* rhs) noexcept {
+        return EqualMask(lhs, vld1q_f32(rhs));
+    }
+};
+
+template <>
+struct NeonOps<double> {
+    static constexpr size_t kLanes = 2;
+
+    static float64x2_t Splat(double value) noexcept {
+        return vdupq_n_f64(value);
+    }
+
+    static unsigned EqualMask(const double* data, float64x2_t splat) noexcept {
+        return NeonOps<uint64_t>::ToMask(vceqq_f64(vld1q_f64(data), splat));
+    }
+
+    static unsigned EqualMask(const double* lhs, const double* rhs) noexcept {
+        return EqualMask(lhs, vld1q_f64(rhs));
+    }
+};
+
+ADVANCED_VECTOR_DEFINE_KERNELS(Neon, NeonOps, )
+
+#endif
+
+#undef ADVANCED_VECTOR_DEFINE_KERNELS
+
+// Тип элементов, которыми работают ядра: float и double сравниваются как числа
+// (NaN не равен себе, -0.0 равен 0.0), побайтово сравнимые типы из 4 и 8 байт —
+// как целые без знака. void означает, что ядра не подходят
+template <typename T>
+using KernelLane = std::conditional_t<
+    std::is_same_v<std::remove_cv_t<T>, float> || std::is_same_v<std::remove_cv_t<T>, double>, std::remove_cv_t<T>,
+    std::conditional_t<IsTriviallyComparableV<T> && sizeof(T) == 4, uint32_t,
+                       std::conditional_t<IsTriviallyComparableV<T> && sizeof(T) == 8, uint64_t, void>>>;
+
+#if defined(ADVANCED_VECTOR_SIMD_SSE2) || defined(ADVANCED_VECTOR_SIMD_NEON)
+template <typename T>
+inline constexpr bool kHasKernels = !std::is_void_v<KernelLane<T>>;
+#else
+template <typename T>
+inline constexpr bool kHasKernels = false;
+#endif
+
+template <typename T>
+int ToByte(const T& value) noexcept {
+    static_assert(sizeof(T) == 1);
+    unsigned char byte;
+    std::memcpy(&byte, &value, 1);
+    return byte;
+}
+
+template <typename T>
+const KernelLane<T>* AsLanes(const T* data) noexcept {
+    return reinterpret_cast<const KernelLane<T>*>(data);
+}
+
+template <typename T>
+KernelLane<T> ToLane(const T& value) noexcept {
+    KernelLane<T> lane;
+    std::memcpy(&lane, &value, sizeof(lane));
+    return lane;
+}
+
+// Индекс первого элемента, равного value, или n
+template <typename T>
+size_t FindIndex(const T* data, size_t n, const T& value) {
+    if constexpr (kHasKernels<T>) {
+#if defined(ADVANCED_VECTOR_SIMD_AVX2)
+        if (HasAvx2()) {
+            return FindAvx2(AsLanes(data), n, ToLane(value));
+        }
+#endif
+#if defined(ADVANCED_VECTOR_SIMD_SSE2)
+        return FindSse2(AsLanes(data), n, ToLane(value));
+#elif defined(ADVANCED_VECTOR_SIMD_NEON)
+        return FindNeon(AsLanes(data), n, ToLane(value));
+#endif
+    }
+    else if constexpr (IsTriviallyComparableV<T> && sizeof(T) == 1) {
+        const void* found = n == 0 ? nullptr : std::memchr(data, ToByte(value), n);
+        return found == nullptr ? n : static_cast<size_t>(static_cast<const T*>(found) - data);
+    }
+    else {
+        return static_cast<size_t>(std::find(data, data + n, value) - data);
+    }
+}
+
+template <typename T>
+size_t CountEqual(const T* data, size_t n, const T& value) {
+    if constexpr (kHasKernels<T>) {
+#if defined(ADVANCED_VECTOR_SIMD_AVX2)
+        if (HasAvx2()) {
+            return CountAvx2(AsLanes(data), n, ToLane(value));
+        }
+#endif
+#if defined(ADVANCED_VECTOR_SIMD_SSE2)
+        return CountSse2(AsLanes(data), n, ToLane(value));
+#elif defined(ADVANCED_VECTOR_SIMD_NEON)
+        return CountNeon(AsLanes(data), n, ToLane(value));
+#endif
+    }
+    else {
+        return static_cast<size_t>(std::count(data, data + n, value));
+    }
+}
+
+// Индекс первой пары различающихся элементов или n
+template <typename T>
+size_t MismatchIndex(const T* lhs, const T* rhs, size_t n) {
+    if constexpr (kHasKernels<T>) {
+#if defined(ADVANCED_VECTOR_SIMD_AVX2)
+        if (HasAvx2()) {
+            return MismatchAvx2(AsLanes(lhs), AsLanes(rhs), n);
+        }
+#endif
+#if defined(ADVANCED_VECTOR_SIMD_SSE2)
+        return MismatchSse2(AsLanes(lhs), AsLanes(rhs), n);
+#elif defined(ADVANCED_VECTOR_SIMD_NEON)
+        return MismatchNeon(AsLanes(lhs), AsLanes(rhs), n);
+#endif
+    }
+    else {
+        return static_cast<size_t>(std::mismatch(lhs, lhs + n, rhs).first - lhs);
+    }
+}
+
+template <typename T>
+bool Equal(const T* lhs, const T* rhs, size_t n) {
+    if constexpr (IsTriviallyComparableV<T>) {
+        return n == 0 || std::memcmp(lhs, rhs, n * sizeof(T)) == 0;
+    }
+    else {
+        return MismatchIndex(lhs, rhs, n) == n;
+    }
+}
+
+// Лексикографическое сравнение по первым различающимся элементам, затем по длине
+template <typename T>
+auto Compare(const T* lhs, size_t lhs_size, const T* rhs, size_t rhs_size) {
+    const size_t common = std::min(lhs_size, rhs_size);
+    if constexpr (IsTriviallyComparableV<T> && sizeof(T) == 1 && std::is_unsigned_v<T>) {
+        // Для беззнаковых байтов порядок memcmp совпадает с порядком элементов
+        if (const int result = common == 0 ? 0 : std::memcmp(lhs, rhs, common); result != 0) {
+            return result <=> 0;
+        }
+        return lhs_size <=> rhs_size;
+    }
+    else {
+        using Ordering = std::compare_three_way_result_t<T>;
+        const size_t index = MismatchIndex(lhs, rhs, common);
+        if (index != common) {
+            return static_cast<Ordering>(lhs[index] <=> rhs[index]);
+        }
+        return static_cast<Ordering>(lhs_size <=> rhs_size);
+    }
+}
+
+// Заполнение однобайтовых типов и значений из одних нулевых байтов сводится к memset.
+// Остальное делает std::fill_n, который компилятор векторизует сам
+template <typename T>
+void Fill(T* data, size_t n, const T& value) {
+    if constexpr (std::is_trivially_copyable_v<T> && IsTriviallyComparableV<T>) {
+        if constexpr (sizeof(T) == 1) {
+            if (n != 0) {
+                std::memset(data, ToByte(value), n);
+            }
+            return;
+        }
+        else {
+            static constexpr unsigned char kZeros[sizeof(T)] = {};
+            if (std::memcmp(&value, kZeros, sizeof(T)) == 0) {
+                if (n != 0) {
+                    std::memset(static_cast<void*>(data), 0, n * sizeof(T));
+                }
+                return;
+            }
+        }
+    }
+    std::fill_n(data, n, value);
+}
+
+}  // namespace simd_detail
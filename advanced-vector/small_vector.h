@@ -0,0 +1,183 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+
+namespace small_vector_detail {
+
+template <typename T, size_t N>
+struct InlineBuffer {
+    T* Data() noexcept {
+        return reinterpret_cast<T*>(bytes);
+    }
+
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+    bool in_use = false;
+};
+
+}  // namespace small_vector_detail
+
+// Отдаёт встроенный буфер на N элементов, пока он свободен и запрос в него помещается,
+// остальные запросы обслуживает кучей. Аллокатор без буфера работает только с кучей
+template <typename T, size_t N>
+class SmallBufferAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    SmallBufferAllocator() = default;
+
+    explicit SmallBufferAllocator(small_vector_detail::InlineBuffer<T, N>* buffer) noexcept
+        : buffer_(buffer) {
+    }
+
+    // Копия вектора не должна ссылаться на встроенный буфер оригинала
+    SmallBufferAllocator select_on_container_copy_construction() const noexcept {
+        return SmallBufferAllocator();
+    }
+
+    T* allocate(size_t n) {
+        if (buffer_ != nullptr && n <= N && !buffer_->in_use) {
+            buffer_->in_use = true;
+            return buffer_->Data();
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (IsInline(ptr)) {
+            buffer_->in_use = false;
+        }
+        else {
+            std::allocator<T>().deallocate(ptr, n);
+        }
+    }
+
+    bool try_expand(T* ptr, size_t /*old_n*/, size_t new_n) const noexcept {
+        return IsInline(ptr) && new_n <= N;
+    }
+
+    bool IsInline(const T* ptr) const noexcept {
+        return buffer_ != nullptr && ptr == buffer_->Data();
+    }
+
+    bool operator==(const SmallBufferAllocator& other) const noexcept {
+        return buffer_ == other.buffer_;
+    }
+
+    bool operator!=(const SmallBufferAllocator& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    small_vector_detail::InlineBuffer<T, N>* buffer_ = nullptr;
+};
+
+// Вектор, хранящий до N элементов внутри объекта и переходящий в кучу при переполнении.
+// Вся логика вставки, удаления и роста унаследована от Vector: встроенный буфер
+// подключается к нему как обычный аллокатор
+template <typename T, size_t N, typename GrowthPolicy = DoublingGrowth, typename StatsPolicy = NoVectorStats>
+class SmallVector : private small_vector_detail::InlineBuffer<T, N>,
+                    public Vector<T, SmallBufferAllocator<T, N>, GrowthPolicy, StatsPolicy> {
+    static_assert(N > 0, "SmallVector needs a non-empty inline buffer");
+
+    using InlineStorage = small_vector_detail::InlineBuffer<T, N>;
+    using Base = Vector<T, SmallBufferAllocator<T, N>, GrowthPolicy, StatsPolicy>;
+
+public:
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallVector()
+        : Base(MakeAllocator()) {
+        Base::Reserve(N);
+    }
+
+    explicit SmallVector(size_t size)
+        : SmallVector() {
+        Base::Reserve(size);
+        Base::Resize(size);
+    }
+
+    SmallVector(std::initializer_list<T> init)
+        : SmallVector() {
+        Base::Append(init);
+    }
+
+    SmallVector(const SmallVector& other)
+        : SmallVector() {
+        Base::operator=(other);
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : Base(MakeAllocator()) {
+        if (other.IsSmall()) {
+            Base::Reserve(N);
+            Base::operator=(std::move(other));
+        }
+        else {
+            StealHeapStorage(other);
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        Base::operator=(rhs);
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                       && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            if (rhs.IsSmall()) {
+                Base::operator=(std::move(rhs));
+            }
+            else {
+                // Освобождаем свой буфер тем же аллокатором, которым он выделен
+                Base released(MakeAllocator());
+                Base::SwapStorage(released);
+                StealHeapStorage(rhs);
+            }
+        }
+        return *this;
+    }
+
+    void Swap(SmallVector& other) {
+        if (!IsSmall() && !other.IsSmall()) {
+            Base::SwapStorage(other);
+        }
+        else {
+            SmallVector temporary(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temporary);
+        }
+    }
+
+    // Буфер может оказаться встроенным: отданный указатель повис бы вместе с объектом,
+    // а встроенный буфер остался бы занятым навсегда
+    RawMemory<T, SmallBufferAllocator<T, N>> ReleaseStorage() = delete;
+    ReleasedBuffer<T> Release() = delete;
+
+    // Элементы лежат во встроенном буфере (или вектор ещё не выделял памяти)
+    [[nodiscard]] bool IsSmall() const noexcept {
+        return Base::Capacity() == 0 || Base::GetAllocator().IsInline(Base::begin());
+    }
+
+private:
+    SmallBufferAllocator<T, N> MakeAllocator() noexcept {
+        return SmallBufferAllocator<T, N>(static_cast<InlineStorage*>(this));
+    }
+
+    // Забирает буфер из кучи у other и возвращает ему встроенный буфер. Память из кучи
+    // освобождается одинаково любым SmallBufferAllocator, поэтому обмен безопасен
+    void StealHeapStorage(SmallVector& other) noexcept {
+        Base::SwapStorage(other);
+        other.Base::Reserve(N);
+    }
+};
@@ -0,0 +1,548 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace soa_vector_detail {
+
+// Столбец переносится без исключений: побайтово или перемещением с noexcept
+template <typename T>
+inline constexpr bool kNothrowRelocatable = IsTriviallyRelocatableV<T> || std::is_nothrow_move_constructible_v<T>;
+
+// Удаляет count элементов столбца начиная с first, сдвигая хвост
+template <typename T>
+void EraseN(T* data, size_t size, size_t first, size_t count) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        std::destroy_n(data + first, count);
+        vector_detail::RelocateBitwise(data + first + count, size - first - count, data + first);
+    }
+    else {
+        std::move(data + first + count, data + size, data + first);
+        std::destroy_n(data + size - count, count);
+    }
+}
+
+}  // namespace soa_vector_detail
+
+// Вектор строк из полей Fields, хранящий каждое поле в отдельном непрерывном столбце
+// (structure of arrays). Цикл, которому нужны два поля из двенадцати, читает только
+// их столбцы. Все столбцы имеют общие размер и вместимость и растут вместе по GrowthPolicy,
+// где размер элемента — суммарный размер строки. Строка доступна как кортеж ссылок
+// на поля, столбец — как std::span
+template <typename Allocator, typename GrowthPolicy, typename... Fields>
+class BasicSoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    template <typename Field>
+    using ColumnAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Field>;
+
+    template <typename Field>
+    using ColumnStorage = RawMemory<Field, ColumnAllocator<Field>>;
+
+    using Columns = std::tuple<ColumnStorage<Fields>...>;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+    // Итератор по строкам. Разыменование даёт кортеж ссылок, а не ссылку на value_type,
+    // поэтому категория итератора — input, хотя арифметика у него как у произвольного доступа
+    template <typename Container, typename Reference>
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = Reference;
+
+        Iterator() = default;
+
+        Iterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index) {
+        }
+
+        // Неконстантный итератор приводится к константному
+        template <typename OtherContainer, typename OtherReference,
+                  std::enable_if_t<std::is_convertible_v<OtherContainer*, Container*>, int> = 0>
+        Iterator(const Iterator<OtherContainer, OtherReference>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*container_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*container_)[index_ + offset];
+        }
+
+        [[nodiscard]] size_t Index() const noexcept {
+            return index_;
+        }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator copy(*this);
+            ++index_;
+            return copy;
+        }
+
+        Iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator copy(*this);
+            --index_;
+            return copy;
+        }
+
+        Iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend Iterator operator+(difference_type offset, Iterator it) noexcept {
+            return it += offset;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.container_ == rhs.container_);
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            assert(lhs.container_ == rhs.container_);
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs - rhs < 0;
+        }
+
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        template <typename, typename>
+        friend class Iterator;
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    using iterator = Iterator<BasicSoAVector, reference>;
+    using const_iterator = Iterator<const BasicSoAVector, const_reference>;
+    using allocator_type = Allocator;
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, value_type>;
+
+    BasicSoAVector() = default;
+
+    explicit BasicSoAVector(const Allocator& alloc) noexcept
+        : columns_(ColumnStorage<Fields>(ColumnAllocator<Fields>(alloc))...)
+        , alloc_(alloc) {
+    }
+
+    explicit BasicSoAVector(size_t size, const Allocator& alloc = Allocator())
+        : BasicSoAVector(alloc) {
+        Resize(size);
+    }
+
+    BasicSoAVector(const BasicSoAVector& other)
+        : BasicSoAVector(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc_)) {
+        Columns new_columns = AllocateColumns(other.size_, Indices{});
+        CopyColumns(other.columns_, new_columns, other.size_, Indices{});
+        columns_.swap(new_columns);
+        capacity_ = ColumnsCapacity(columns_, Indices{});
+        size_ = other.size_;
+    }
+
+    // Столбцы переходят к новому вектору вместе с аллокаторами, элементы не перемещаются
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , alloc_(other.alloc_)
+        , capacity_(std::exchange(other.capacity_, 0))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    BasicSoAVector& operator=(const BasicSoAVector& rhs) {
+        if (this != &rhs) {
+            BasicSoAVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    BasicSoAVector& operator=(BasicSoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            columns_ = std::move(rhs.columns_);
+            alloc_ = rhs.alloc_;
+            capacity_ = std::exchange(rhs.capacity_, 0);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~BasicSoAVector() {
+        Clear();
+    }
+
+    void Swap(BasicSoAVector& other) noexcept {
+        SwapColumns(other.columns_, Indices{});
+        std::swap(alloc_, other.alloc_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            Columns new_columns = AllocateColumns(new_capacity, Indices{});
+            RelocateColumns(new_columns);
+        }
+    }
+
+    void ShrinkToFit() {
+        if (capacity_ > size_) {
+            Columns new_columns = AllocateColumns(size_, Indices{});
+            RelocateColumns(new_columns);
+        }
+    }
+
+    // Новые строки инициализируются значениями по умолчанию
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyRows(size_ - new_size);
+        }
+        else if (new_size > size_) {
+            if (new_size > capacity_) {
+                Reserve(CalculateGrowth(new_size));
+            }
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+        }
+    }
+
+    // Создаёт строку из значений полей по одному аргументу на поле; без аргументов
+    // все поля инициализируются по умолчанию. Строгая гарантия безопасности исключений
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == 0 || sizeof...(Args) == sizeof...(Fields),
+                      "EmplaceBack takes one argument per field");
+        if (size_ == capacity_) {
+            // Строка создаётся в новом буфере до переноса старых: аргументы могут
+            // ссылаться на поля этого же вектора
+            Columns new_columns = AllocateColumns(CalculateGrowth(size_ + 1), Indices{});
+            ConstructRow(new_columns, size_, Indices{}, std::forward<Args>(args)...);
+            try {
+                RelocateColumns(new_columns);
+            }
+            catch (...) {
+                DestroyRow(new_columns, size_, sizeof...(Fields), Indices{});
+                throw;
+            }
+        }
+        else {
+            ConstructRow(columns_, size_, Indices{}, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const value_type& row) {
+        std::apply(
+            [this](const Fields&... fields) {
+                EmplaceBack(fields...);
+            },
+            row);
+    }
+
+    void PushBack(value_type&& row) {
+        std::apply(
+            [this](Fields&... fields) {
+                EmplaceBack(std::move(fields)...);
+            },
+            row);
+    }
+
+    void PopBack() noexcept {
+        assert(size_);
+        DestroyRows(1);
+    }
+
+    void Clear() noexcept {
+        DestroyRows(size_);
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    // Каждый столбец сдвигается независимо. Если перемещающее присваивание поля бросает,
+    // гарантия только базовая, как у Vector::Erase
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t first_pos = first.Index();
+        const size_t count = last - first;
+        if (count != 0) {
+            EraseColumns(first_pos, count, Indices{});
+            size_ -= count;
+        }
+        return begin() + first_pos;
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Непрерывный столбец поля I, например для SIMD-цикла или simd_detail::FindIndex
+    template <size_t I>
+    std::span<FieldType<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    std::span<const FieldType<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Row(index, Indices{});
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Row(index, Indices{});
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+private:
+    Columns columns_;
+    [[no_unique_address]] Allocator alloc_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+
+    size_t CalculateGrowth(size_t min_capacity) const noexcept {
+        return GrowthPolicy::NewCapacity(capacity_, min_capacity, kRowSize);
+    }
+
+    template <size_t... I>
+    Columns AllocateColumns(size_t capacity, std::index_sequence<I...>) const {
+        return Columns(ColumnStorage<Fields>(capacity, ColumnAllocator<Fields>(alloc_))...);
+    }
+
+    // allocate_at_least может выделить столбцам разную вместимость; общая — наименьшая
+    template <size_t... I>
+    static size_t ColumnsCapacity(const Columns& columns, std::index_sequence<I...>) noexcept {
+        return std::min({std::get<I>(columns).Capacity()...});
+    }
+
+    template <size_t... I>
+    void SwapColumns(Columns& other, std::index_sequence<I...>) noexcept {
+        (std::get<I>(columns_).Swap(std::get<I>(other)), ...);
+    }
+
+    template <size_t... I>
+    reference Row(size_t index, std::index_sequence<I...>) noexcept {
+        return reference(std::get<I>(columns_)[index]...);
+    }
+
+    template <size_t... I>
+    const_reference Row(size_t index, std::index_sequence<I...>) const noexcept {
+        return const_reference(std::get<I>(columns_)[index]...);
+    }
+
+    // Разрушает первые count полей строки index
+    template <size_t... I>
+    static void DestroyRow(Columns& columns, size_t index, size_t count, std::index_sequence<I...>) noexcept {
+        ((I < count ? std::destroy_at(std::get<I>(columns) + index) : void()), ...);
+    }
+
+    template <size_t... I, typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, std::index_sequence<I...>, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            if constexpr (sizeof...(Args) == 0) {
+                ((new (std::get<I>(columns) + index) Fields(), ++constructed), ...);
+            }
+            else {
+                auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+                ((new (std::get<I>(columns) + index) Fields(std::get<I>(std::move(values))), ++constructed), ...);
+            }
+        }
+        catch (...) {
+            DestroyRow(columns, index, constructed, std::index_sequence<I...>{});
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    static void CopyColumns(const Columns& src, Columns& dst, size_t size, std::index_sequence<I...>) {
+        size_t copied = 0;
+        try {
+            ((vector_detail::UninitializedCopyN(std::get<I>(src).GetAddress(), size, std::get<I>(dst).GetAddress()),
+              ++copied),
+             ...);
+        }
+        catch (...) {
+            ((I < copied ? (void)std::destroy_n(std::get<I>(dst).GetAddress(), size) : void()), ...);
+            throw;
+        }
+    }
+
+    // Переносит строки в new_columns и делает их текущими. Столбцы, перенос которых может
+    // бросить, сначала копируются, и лишь после этого переносятся остальные: при исключении
+    // ни один столбец исходного вектора ещё не тронут. Некопируемые столбцы с бросающим
+    // перемещением перемещаются, как в UninitializedMoveOrCopyN, и дают лишь базовую гарантию:
+    // строки остаются на месте, но часть их значений может оказаться перемещённой
+    void RelocateColumns(Columns& new_columns) {
+        CopyThrowingColumns(new_columns, Indices{});
+        RelocateNothrowColumns(new_columns, Indices{});
+        columns_.swap(new_columns);
+        capacity_ = ColumnsCapacity(columns_, Indices{});
+    }
+
+    template <size_t... I>
+    void CopyThrowingColumns(Columns& new_columns, std::index_sequence<I...>) {
+        size_t copied = 0;
+        try {
+            ((CopyColumnIfThrowing<I>(new_columns), ++copied), ...);
+        }
+        catch (...) {
+            ((I < copied ? DestroyColumnIfThrowing<I>(new_columns) : void()), ...);
+            throw;
+        }
+        (DestroyColumnIfThrowing<I>(columns_), ...);
+    }
+
+    template <size_t I>
+    void CopyColumnIfThrowing(Columns& new_columns) {
+        if constexpr (!soa_vector_detail::kNothrowRelocatable<FieldType<I>>) {
+            vector_detail::UninitializedMoveOrCopyN(std::get<I>(columns_).GetAddress(), size_,
+                                                    std::get<I>(new_columns).GetAddress());
+        }
+    }
+
+    template <size_t I>
+    void DestroyColumnIfThrowing(Columns& columns) noexcept {
+        if constexpr (!soa_vector_detail::kNothrowRelocatable<FieldType<I>>) {
+            std::destroy_n(std::get<I>(columns).GetAddress(), size_);
+        }
+    }
+
+    template <size_t... I>
+    void RelocateNothrowColumns(Columns& new_columns, std::index_sequence<I...>) noexcept {
+        (RelocateColumnIfNothrow<I>(new_columns), ...);
+    }
+
+    template <size_t I>
+    void RelocateColumnIfNothrow(Columns& new_columns) noexcept {
+        if constexpr (soa_vector_detail::kNothrowRelocatable<FieldType<I>>) {
+            vector_detail::UninitializedRelocateN(std::get<I>(columns_).GetAddress(), size_,
+                                                  std::get<I>(new_columns).GetAddress());
+        }
+    }
+
+    template <size_t... I>
+    void EraseColumns(size_t first, size_t count, std::index_sequence<I...>) {
+        (soa_vector_detail::EraseN(std::get<I>(columns_).GetAddress(), size_, first, count), ...);
+    }
+
+    void DestroyRows(size_t count) noexcept {
+        DestroyTail(count, Indices{});
+        size_ -= count;
+    }
+
+    template <size_t... I>
+    void DestroyTail(size_t count, std::index_sequence<I...>) noexcept {
+        (std::destroy_n(std::get<I>(columns_).GetAddress() + size_ - count, count), ...);
+    }
+};
+
+template <typename... Fields>
+using SoAVector = BasicSoAVector<std::allocator<std::byte>, DoublingGrowth, Fields...>;
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace static_vector_detail {
+
+// Хранилище на N элементов. Для нетривиальных T элементы живут в объединении и создаются
+// по одному; такое хранилище тривиально копируется и разрушается, если таков T
+template <typename T, size_t N,
+          bool = std::is_trivially_default_constructible_v<T> && std::is_trivially_copyable_v<T>>
+struct Storage {
+    constexpr Storage() noexcept {
+    }
+
+    constexpr ~Storage() requires std::is_trivially_destructible_v<T> = default;
+
+    constexpr ~Storage() {
+    }
+
+    union {
+        T data[N];
+    };
+};
+
+// Тривиальные элементы хранятся обычным массивом. Вне constexpr массив не инициализируется,
+// а на этапе компиляции обнуляется: константа времени компиляции не может содержать
+// неинициализированных байтов, даже за концом вектора
+template <typename T, size_t N>
+struct Storage<T, N, true> {
+    constexpr Storage() noexcept {
+        if (std::is_constant_evaluated()) {
+            for (T& element : data) {
+                element = T();
+            }
+        }
+    }
+
+    T data[N];
+};
+
+}  // namespace static_vector_detail
+
+// Вектор с вместимостью N во встроенном хранилище: без кучи, без RawMemory и без роста.
+// Проверка вместимости при вставке — одно сравнение; переполнение завершается std::bad_alloc.
+// Копирование и разрушение тривиальны, когда тривиален T, а весь интерфейс доступен в constexpr,
+// поэтому вектор годится для таблиц, вычисляемых при компиляции
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0, "StaticVector needs a positive capacity");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr StaticVector() noexcept = default;
+
+    constexpr explicit StaticVector(size_t size) {
+        CheckCapacity(size);
+        vector_detail::UninitializedValueConstructN(begin(), size);
+        size_ = size;
+    }
+
+    constexpr StaticVector(std::initializer_list<T> init) {
+        CheckCapacity(init.size());
+        vector_detail::UninitializedCopyN(init.begin(), init.size(), begin());
+        size_ = init.size();
+    }
+
+    StaticVector(const StaticVector&) requires std::is_trivially_copy_constructible_v<T> = default;
+
+    constexpr StaticVector(const StaticVector& other) {
+        vector_detail::UninitializedCopyN(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    StaticVector(StaticVector&&) requires std::is_trivially_move_constructible_v<T> = default;
+
+    constexpr StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        vector_detail::UninitializedCopyN(std::make_move_iterator(other.begin()), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    StaticVector& operator=(const StaticVector&)
+        requires std::is_trivially_copy_assignable_v<T> && std::is_trivially_copy_constructible_v<T>
+                     && std::is_trivially_destructible_v<T>
+    = default;
+
+    constexpr StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            AssignN(rhs.begin(), rhs.size_);
+        }
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&&)
+        requires std::is_trivially_move_assignable_v<T> && std::is_trivially_move_constructible_v<T>
+                     && std::is_trivially_destructible_v<T>
+    = default;
+
+    constexpr StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                   && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            AssignN(std::make_move_iterator(rhs.begin()), rhs.size_);
+        }
+        return *this;
+    }
+
+    constexpr ~StaticVector() requires std::is_trivially_destructible_v<T> = default;
+
+    constexpr ~StaticVector() {
+        std::destroy_n(begin(), size_);
+    }
+
+    [[nodiscard]] constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    constexpr const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return storage_.data[index];
+    }
+
+    constexpr T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return storage_.data[index];
+    }
+
+    constexpr iterator begin() noexcept {
+        return storage_.data;
+    }
+
+    constexpr iterator end() noexcept {
+        return storage_.data + size_;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return cend();
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return storage_.data;
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return storage_.data + size_;
+    }
+
+    // Новые элементы инициализируются значениями по умолчанию
+    constexpr void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        }
+        else {
+            CheckCapacity(new_size);
+            vector_detail::UninitializedValueConstructN(end(), new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    constexpr void Clear() noexcept {
+        std::destroy_n(begin(), size_);
+        size_ = 0;
+    }
+
+    template <typename T1>
+    constexpr void PushBack(T1&& value) {
+        EmplaceBack(std::forward<T1>(value));
+    }
+
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+        T* slot = std::construct_at(end(), std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_);
+        --size_;
+        std::destroy_at(end());
+    }
+
+    // Элементы сдвигаются перемещением, как у Vector без тривиального переноса
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos - cbegin();
+        CheckCapacity(size_ + 1);
+        if (index == size_) {
+            std::construct_at(end(), std::forward<Args>(args)...);
+        }
+        else {
+            // Аргументы могут ссылаться на сдвигаемые элементы
+            T temporary_obj(std::forward<Args>(args)...);
+            std::construct_at(end(), std::move(*(end() - 1)));
+            try {
+                std::move_backward(begin() + index, end() - 1, end());
+                storage_.data[index] = std::move(temporary_obj);
+            }
+            catch (...) {
+                std::destroy_at(end());
+                throw;
+            }
+        }
+        ++size_;
+        return begin() + index;
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    constexpr iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    constexpr iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t first_pos = first - cbegin();
+        const size_t count = last - first;
+        std::move(begin() + first_pos + count, end(), begin() + first_pos);
+        std::destroy_n(end() - count, count);
+        size_ -= count;
+        return begin() + first_pos;
+    }
+
+    friend constexpr bool operator==(const StaticVector& lhs, const StaticVector& rhs)
+        requires std::equality_comparable<T>
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    friend constexpr auto operator<=>(const StaticVector& lhs, const StaticVector& rhs)
+        requires std::three_way_comparable<T>
+    {
+        return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    static_vector_detail::Storage<T, N> storage_;
+    size_t size_ = 0;
+
+    static constexpr void CheckCapacity(size_t size) {
+        if (size > N) {
+            throw std::bad_alloc();
+        }
+    }
+
+    template <typename InputIt>
+    constexpr void AssignN(InputIt src, size_t n) {
+        const size_t common = std::min(size_, n);
+        src = vector_detail::CopyN(src, common, begin());
+        if (size_ > n) {
+            std::destroy_n(begin() + n, size_ - n);
+        }
+        else {
+            vector_detail::UninitializedCopyN(src, n - common, begin() + common);
+        }
+        size_ = n;
+    }
+};
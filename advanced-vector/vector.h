@@ -1,243 +1,1052 @@
 #pragma once
 
+#include "growth_policy.h"
+#include "parallel_execution.h"
+#include "prefetch.h"
+#include "simd_algorithms.h"
+#include "vector_stats.h"
+
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <concepts>
+#include <initializer_list>
+#include <iterator>
 #include <new>
 #include <memory>
+#include <source_location>
+#include <span>
+#include <type_traits>
 #include <utility>
 
+// Медленный путь, вынесенный из горячего цикла: не встраивается и размещается вместе
+// с редко исполняемым кодом
+#if defined(__GNUC__) || defined(__clang__)
+#define ADVANCED_VECTOR_COLD __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+#define ADVANCED_VECTOR_COLD __declspec(noinline)
+#else
+#define ADVANCED_VECTOR_COLD
+#endif
+
+// Тип тривиально перемещаемый, если перенос объекта на новый адрес можно выполнить
+// побайтовым копированием без вызова конструктора перемещения и деструктора источника.
+// Для типов вроде обёрток над std::unique_ptr признак можно включить специализацией
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Разрешает переносить элементы при росте конструктором перемещения, даже если он не noexcept.
+// Без признака такие копируемые типы переносятся копированием ради строгой гарантии;
+// с ним рост дешевле, но гарантия только базовая: если перемещение бросит исключение,
+// вектор останется в старом буфере, а часть его элементов может оказаться перемещённой
+template <typename T>
+struct RelocateByMove : std::false_type {
+};
+
+template <typename T>
+inline constexpr bool RelocateByMoveV = RelocateByMove<T>::value;
+
+// Истинно для типов, которые при росте вектора переносятся копированием. Годится для проверок
+// вида static_assert(!RelocatesByCopyV<Record>), а с ADVANCED_VECTOR_WARN_ON_COPY_RELOCATION
+// компилятор предупреждает о каждом таком типе, для которого инстанцирован перенос
+template <typename T>
+inline constexpr bool RelocatesByCopyV = !IsTriviallyRelocatableV<T> && !std::is_nothrow_move_constructible_v<T>
+                                         && std::is_copy_constructible_v<T> && !RelocateByMoveV<T>;
+
+namespace vector_detail {
+
+// Алгоритмы из <memory> вида uninitialized_* станут constexpr только в C++26, поэтому
+// при вычислении на этапе компиляции функции ниже создают объекты через std::construct_at.
+// Исключения там невозможны, и откатывать частично созданное не нужно
+
+template <typename T>
+inline constexpr bool kMoveOnRelocate = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>
+                                        || RelocateByMoveV<T>;
+
+#ifdef ADVANCED_VECTOR_WARN_ON_COPY_RELOCATION
+template <typename T>
+[[deprecated("elements are copied on reallocation: make the move constructor noexcept or specialize RelocateByMove")]]
+constexpr void NoteCopyRelocation() noexcept {
+}
+#endif
+
+// Перемещает элементы, если это не нарушает строгую гарантию безопасности исключений
+// или тип разрешил это через RelocateByMove, иначе копирует. Исходные объекты остаются живыми
+template <typename T>
+constexpr void UninitializedMoveOrCopyN(T* src, size_t n, T* dst) {
+#ifdef ADVANCED_VECTOR_WARN_ON_COPY_RELOCATION
+    if constexpr (!kMoveOnRelocate<T>) {
+        NoteCopyRelocation<T>();
+    }
+#endif
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            if constexpr (kMoveOnRelocate<T>) {
+                std::construct_at(dst + i, std::move(src[i]));
+            }
+            else {
+                std::construct_at(dst + i, std::as_const(src[i]));
+            }
+        }
+    }
+    else if constexpr (kMoveOnRelocate<T>) {
+        std::uninitialized_move_n(src, n, dst);
+    }
+    else {
+        std::uninitialized_copy_n(src, n, dst);
+    }
+}
+
+template <typename T>
+constexpr void UninitializedValueConstructN(T* dst, size_t n) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            std::construct_at(dst + i);
+        }
+    }
+    else {
+        std::uninitialized_value_construct_n(dst, n);
+    }
+}
+
+// Неинициализированное значение нельзя прочитать при компиляции, поэтому там элементы
+// инициализируются значением
+template <typename T>
+constexpr void UninitializedDefaultConstructN(T* dst, size_t n) {
+    if (std::is_constant_evaluated()) {
+        UninitializedValueConstructN(dst, n);
+    }
+    else {
+        std::uninitialized_default_construct_n(dst, n);
+    }
+}
+
+// Побайтово переносит n тривиально перемещаемых объектов; области могут перекрываться.
+// На этапе компиляции memmove недоступен, а порядок перекрывающихся областей нельзя узнать
+// сравнением указателей, поэтому объекты переносятся через временный буфер
+template <typename T>
+constexpr void RelocateBitwise(T* src, size_t n, T* dst) noexcept {
+    static_assert(IsTriviallyRelocatableV<T>);
+    if (n == 0) {
+        return;
+    }
+    if (std::is_constant_evaluated()) {
+        std::allocator<T> alloc;
+        T* buffer = alloc.allocate(n);
+        for (size_t i = 0; i < n; ++i) {
+            std::construct_at(buffer + i, std::move(src[i]));
+            std::destroy_at(src + i);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            std::construct_at(dst + i, std::move(buffer[i]));
+            std::destroy_at(buffer + i);
+        }
+        alloc.deallocate(buffer, n);
+    }
+    else {
+        std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+    }
+}
+
+// Переносит n объектов в неинициализированную память dst. После успешного
+// завершения объекты в src разрушены, при исключении src остаётся нетронутым
+template <typename T>
+constexpr void UninitializedRelocateN(T* src, size_t n, T* dst) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        RelocateBitwise(src, n, dst);
+    }
+    else {
+        UninitializedMoveOrCopyN(src, n, dst);
+        std::destroy_n(src, n);
+    }
+}
+
+// Параллельный вариант UninitializedRelocateN для непересекающихся буферов
+template <typename T>
+void UninitializedRelocateN(T* src, size_t n, T* dst, const ParallelExecution& policy) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        parallel_detail::ForEachChunk(n, policy, [src, dst](size_t first, size_t count) noexcept {
+            RelocateBitwise(src + first, count, dst + first);
+        });
+    }
+    else {
+        parallel_detail::ForEachChunk(
+            n, policy,
+            [src, dst](size_t first, size_t count) {
+                UninitializedMoveOrCopyN(src + first, count, dst + first);
+            },
+            [dst](size_t first, size_t count) noexcept {
+                std::destroy_n(dst + first, count);
+            });
+        parallel_detail::DestroyN(src, n, policy);
+    }
+}
+
+// Источник, который можно копировать побайтово: указатель на тривиально копируемые T или
+// move_iterator над ним (перемещение таких объектов и есть копирование)
+template <typename It, typename T>
+struct IsBulkCopySource : std::false_type {
+};
+
+template <typename T>
+struct IsBulkCopySource<T*, T> : std::is_trivially_copyable<T> {
+};
+
 template <typename T>
+struct IsBulkCopySource<const T*, T> : std::is_trivially_copyable<T> {
+};
+
+template <typename It, typename T>
+struct IsBulkCopySource<std::move_iterator<It>, T> : IsBulkCopySource<It, T> {
+};
+
+template <typename It>
+const void* SourceAddress(It it) noexcept {
+    if constexpr (std::is_pointer_v<It>) {
+        return it;
+    }
+    else {
+        return it.base();
+    }
+}
+
+// Копирует n элементов в неинициализированную память. Из непрерывного источника
+// тривиально копируемых объектов копирует одним memcpy. При исключении уже созданные
+// копии разрушаются
+template <typename ForwardIt, typename T>
+constexpr void UninitializedCopyN(ForwardIt first, size_t n, T* dst) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < n; ++i, ++first) {
+            std::construct_at(dst + i, *first);
+        }
+    }
+    else if constexpr (IsBulkCopySource<ForwardIt, T>::value) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dst), SourceAddress(first), n * sizeof(T));
+        }
+    }
+    else {
+        std::uninitialized_copy_n(first, n, dst);
+    }
+}
+
+// Присваивает n элементов из first живым объектам dst и возвращает продвинутый итератор.
+// Побайтовый путь использует memmove: источник может лежать в том же буфере
+template <typename InputIt, typename T>
+constexpr InputIt CopyN(InputIt first, size_t n, T* dst) {
+    if constexpr (IsBulkCopySource<InputIt, T>::value) {
+        if (!std::is_constant_evaluated()) {
+            if (n != 0) {
+                std::memmove(static_cast<void*>(dst), SourceAddress(first), n * sizeof(T));
+            }
+            return first + n;
+        }
+    }
+    for (size_t i = 0; i < n; ++i, ++first) {
+        dst[i] = *first;
+    }
+    return first;
+}
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+template <typename It, typename = void>
+struct IsInputIterator : std::false_type {
+};
+
+template <typename It>
+struct IsInputIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::input_iterator_tag> {
+};
+
+template <typename It, typename = void>
+struct IsForwardIterator : std::false_type {
+};
+
+template <typename It>
+struct IsForwardIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::forward_iterator_tag> {
+};
+
+template <typename Range, typename = void>
+struct IsContiguousRange : std::false_type {
+};
+
+template <typename Range>
+struct IsContiguousRange<Range, std::void_t<decltype(std::data(std::declval<const Range&>())),
+                                            decltype(std::size(std::declval<const Range&>()))>>
+    : std::true_type {
+};
+
+// Итератор по последовательности из count копий одного значения
+template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    RepeatIterator(const T* value, size_t index) noexcept
+        : value_(value)
+        , index_(index) {
+    }
+
+    reference operator*() const noexcept {
+        return *value_;
+    }
+
+    pointer operator->() const noexcept {
+        return value_;
+    }
+
+    RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    RepeatIterator operator++(int) noexcept {
+        RepeatIterator copy(*this);
+        ++index_;
+        return copy;
+    }
+
+    bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+
+    bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+private:
+    const T* value_;
+    size_t index_;
+};
+
+template <typename Allocator, typename = void>
+struct HasAllocateAtLeast : std::false_type {
+};
+
+template <typename Allocator>
+struct HasAllocateAtLeast<Allocator, std::void_t<decltype(std::declval<Allocator&>().allocate_at_least(size_t{}).ptr),
+                                                  decltype(std::declval<Allocator&>().allocate_at_least(size_t{}).count)>>
+    : std::true_type {
+};
+
+template <typename StatsPolicy, typename = void>
+struct HasGrowthTracing : std::false_type {
+};
+
+template <typename StatsPolicy>
+struct HasGrowthTracing<StatsPolicy, std::void_t<decltype(std::declval<StatsPolicy&>().OnGrowth(
+                                         std::declval<const GrowthEvent&>()))>> : std::true_type {
+};
+
+template <typename Allocator, typename = void>
+struct HasTryExpand : std::false_type {
+};
+
+template <typename Allocator>
+struct HasTryExpand<Allocator, std::void_t<decltype(bool(std::declval<Allocator&>().try_expand(
+                                   std::declval<typename Allocator::value_type*>(), size_t{}, size_t{})))>>
+    : std::true_type {
+};
+
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {
+};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(static_cast<typename Allocator::value_type*>(
+                                    std::declval<Allocator&>().reallocate(std::declval<typename Allocator::value_type*>(),
+                                                                          size_t{}, size_t{})))>>
+    : std::true_type {
+};
+
+}  // namespace vector_detail
+
+// Результат allocate_at_least: аллокатор может выделить больше запрошенного и сообщить об этом
+template <typename Pointer>
+struct AllocationResult {
+    Pointer ptr;
+    size_t count;
+};
+
+// Буфер, отданный вектором вызывающему вместе с живыми элементами. Владелец разрушает
+// первые size элементов и освобождает capacity элементов аллокатором вектора
+template <typename T>
+struct ReleasedBuffer {
+    T* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Помимо стандартного интерфейса аллокатор может предоставить необязательные методы:
+//   allocate_at_least(n) -> AllocationResult — выделить не меньше n элементов;
+//   try_expand(p, old_n, new_n) -> bool — расширить блок на месте, не перемещая его;
+//   reallocate(p, old_n, new_n) -> T* — расширить блок, возможно переместив содержимое
+//     побайтово (как realloc); при неудаче возвращает nullptr и не трогает исходный блок
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+    using allocator_type = Allocator;
+
+    static constexpr bool kCanExpandInPlace = vector_detail::HasTryExpand<Allocator>::value;
+    static constexpr bool kCanReallocate = vector_detail::HasReallocate<Allocator>::value;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    constexpr explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    constexpr explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc) {
+        if (capacity != 0) {
+            if constexpr (vector_detail::HasAllocateAtLeast<Allocator>::value) {
+                auto result = alloc_.allocate_at_least(capacity);
+                assert(result.count >= capacity);
+                buffer_ = result.ptr;
+                capacity_ = result.count;
+            }
+            else {
+                buffer_ = AllocTraits::allocate(alloc_, capacity);
+                capacity_ = capacity;
+            }
+        }
+    }
+
+    // Принимает во владение буфер на capacity элементов, выделенный аллокатором alloc
+    // или совместимым с ним: буфер будет освобождён через alloc
+    constexpr RawMemory(T* buffer, size_t capacity, const Allocator& alloc) noexcept
+        : alloc_(alloc)
+        , buffer_(buffer)
         , capacity_(capacity) {
+        assert(buffer != nullptr || capacity == 0);
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
-    RawMemory(RawMemory&& other) noexcept
-        : buffer_(std::exchange(other.buffer_, nullptr))
+    constexpr RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
         , capacity_(std::exchange(other.capacity_, 0))
     {
     }
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
+    // Буфер освобождается тем аллокатором, которым он был выделен,
+    // поэтому вместе с памятью переходит и аллокатор
+    constexpr RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
-            Swap(rhs);
+            Deallocate(buffer_, capacity_);
+            alloc_ = std::move(rhs.alloc_);
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+            capacity_ = std::exchange(rhs.capacity_, 0);
         }
         return *this;
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    constexpr ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    constexpr T* operator+(size_t offset) noexcept {
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    constexpr const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Отказывается от владения буфером, не освобождая его
+    constexpr T* Release() noexcept {
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    constexpr void Swap(RawMemory& other) noexcept {
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
     }
 
-    const T* GetAddress() const noexcept {
+    constexpr const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    constexpr T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    constexpr size_t Capacity() const noexcept {
         return capacity_;
     }
 
+    // Пытается увеличить вместимость, не перемещая буфер; указатели на элементы остаются валидными
+    constexpr bool TryExpandInPlace(size_t new_capacity) noexcept {
+        if constexpr (kCanExpandInPlace) {
+            if (!std::is_constant_evaluated() && buffer_ != nullptr
+                && alloc_.try_expand(buffer_, capacity_, new_capacity)) {
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Пытается увеличить вместимость перевыделением с побайтовым переносом содержимого.
+    // Годится только для тривиально перемещаемых T; при успехе буфер может сменить адрес
+    constexpr bool TryReallocate(size_t new_capacity) noexcept {
+        static_assert(IsTriviallyRelocatableV<T>, "reallocate moves objects bitwise");
+        if constexpr (kCanReallocate) {
+            if (!std::is_constant_evaluated() && buffer_ != nullptr) {
+                if (T* new_buffer = alloc_.reallocate(buffer_, capacity_, new_capacity)) {
+                    buffer_ = new_buffer;
+                    capacity_ = new_capacity;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    constexpr const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    constexpr Allocator& GetAllocator() noexcept {
+        return alloc_;
+    }
+
 private:
+    [[no_unique_address]] Allocator alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    constexpr void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+        }
     }
+};
 
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
-    }
+// Тег для конструкторов и операций, которые создают элементы инициализацией по умолчанию:
+// тривиальные типы при этом не обнуляются
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
 };
 
-template <typename T>
+inline constexpr DefaultInitTag kDefaultInit{};
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename StatsPolicy = NoVectorStats>
 class Vector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+    using value_type = T;
     using iterator = T*;
     using const_iterator = const T*;
+    using allocator_type = Allocator;
 
     Vector() = default;
 
-    explicit Vector(size_t size)
-        : data_(size)
+    constexpr explicit Vector(const Allocator& alloc) noexcept
+        : data_(alloc)
+    {
+    }
+
+    constexpr explicit Vector(size_t size, const Allocator& alloc = Allocator())
+        : data_(AllocateStorage(size, alloc))
+        , size_(size)
+    {
+        vector_detail::UninitializedValueConstructN(begin(), size);
+    }
+
+    constexpr Vector(size_t size, DefaultInitTag, const Allocator& alloc = Allocator())
+        : data_(AllocateStorage(size, alloc))
         , size_(size)
     {
-        std::uninitialized_value_construct_n(begin(), size);
+        vector_detail::UninitializedDefaultConstructN(begin(), size);
     }
 
-    Vector(const Vector& other)
-        : data_(other.size_)
+    // Создаёт элементы параллельно; при исключении в любом потоке разрушает все созданные
+    Vector(size_t size, const ParallelExecution& policy, const Allocator& alloc = Allocator())
+        : data_(AllocateStorage(size, alloc))
+    {
+        parallel_detail::UninitializedValueConstructN(begin(), size, policy);
+        size_ = size;
+    }
+
+    template <typename InputIt, std::enable_if_t<vector_detail::IsInputIterator<InputIt>::value, int> = 0>
+    constexpr Vector(InputIt first, InputIt last, const Allocator& alloc = Allocator(),
+                     std::source_location location = std::source_location::current())
+        : data_(alloc)
+    {
+        if constexpr (vector_detail::IsForwardIterator<InputIt>::value) {
+            const size_t count = std::distance(first, last);
+            RawMemory<T, Allocator> new_data = AllocateStorage(count, alloc);
+            vector_detail::UninitializedCopyN(first, count, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = count;
+        }
+        else {
+            InsertInputRange(0, first, last, "Construct", location);
+        }
+    }
+
+    constexpr Vector(std::initializer_list<T> init, const Allocator& alloc = Allocator())
+        : Vector(init.begin(), init.end(), alloc)
+    {
+    }
+
+    constexpr Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+    {
+    }
+
+    constexpr Vector(const Vector& other, const Allocator& alloc)
+        : data_(AllocateStorage(other.size_, alloc))
         , size_(other.size_)
     {
-        std::uninitialized_copy_n(other.begin(), size_, begin());
+        vector_detail::UninitializedCopyN(other.begin(), size_, begin());
     }
 
-    Vector(Vector&& other) noexcept
+    Vector(const Vector& other, const ParallelExecution& policy)
+        : Vector(other, policy, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator()))
+    {
+    }
+
+    Vector(const Vector& other, const ParallelExecution& policy, const Allocator& alloc)
+        : data_(AllocateStorage(other.size_, alloc))
+    {
+        parallel_detail::UninitializedCopyN(other.begin(), other.size_, begin(), policy);
+        size_ = other.size_;
+    }
+
+    constexpr Vector(Vector&& other) noexcept
         : data_(std::move(other.data_))
         , size_(std::exchange(other.size_, 0))
     {
     }
 
-    Vector& operator=(const Vector& rhs) {
+    constexpr Vector(Vector&& other, const Allocator& alloc)
+        : data_(alloc)
+    {
+        if (AllocTraits::is_always_equal::value || alloc == other.data_.GetAllocator()) {
+            data_.Swap(other.data_);
+            size_ = std::exchange(other.size_, 0);
+        }
+        else {
+            RawMemory<T, Allocator> new_data = AllocateStorage(other.size_, alloc);
+            vector_detail::UninitializedCopyN(std::make_move_iterator(other.begin()), other.size_,
+                                              new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+        }
+    }
+
+    // Оператор не может принять место вызова, поэтому рост записывается с пустым location;
+    // Assign(rhs.begin(), rhs.end()) записывает место вызова
+    constexpr Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
-            if (rhs.size_ > Capacity()) {
-                Vector copied_rhs(rhs);
-                Swap(copied_rhs);
-            }
-            else {
-                size_t pos = 0;
-                for (; pos < std::min(size_, rhs.size_); ++pos) {
-                    data_[pos] = rhs.data_[pos];
-                }
-                if (size_ > rhs.size_) {
-                    std::destroy_n(&data_[rhs.size_], size_ - rhs.size_);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (!AllocTraits::is_always_equal::value && data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    // Текущий буфер нельзя переиспользовать: его нужно вернуть старому аллокатору
+                    TraceGrowth("Assign", std::source_location(), [&] {
+                        RawMemory<T, Allocator> new_data = AllocateStorage(CalculateGrowth(rhs.size_),
+                                                                           rhs.data_.GetAllocator());
+                        vector_detail::UninitializedCopyN(rhs.begin(), rhs.size_, new_data.GetAddress());
+                        std::destroy_n(begin(), size_);
+                        data_ = std::move(new_data);
+                        size_ = rhs.size_;
+                        return size_t(0);
+                    });
+                    return *this;
                 }
-                else {
-                    std::uninitialized_copy_n(&rhs.data_[pos], rhs.size_ - size_, &data_[pos]);
-                }
-                size_ = rhs.size_;
+                data_.GetAllocator() = rhs.data_.GetAllocator();
             }
+            AssignN(rhs.begin(), rhs.size_, std::source_location());
         }
         return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
+    constexpr Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            Swap(rhs);
+            if (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value
+                || data_.GetAllocator() == rhs.data_.GetAllocator()) {
+                std::destroy_n(begin(), size_);
+                data_ = std::move(rhs.data_);
+                size_ = std::exchange(rhs.size_, 0);
+            }
+            else {
+                // Чужой буфер забрать нельзя, поэтому элементы перемещаются по одному
+                AssignN(std::make_move_iterator(rhs.begin()), rhs.size_, std::source_location());
+            }
         }
         return *this;
     }
 
-    ~Vector() {
+    constexpr ~Vector() {
         std::destroy_n(begin(), size_);
     }
 
-    void Swap(Vector& other) noexcept {
-        data_.Swap(other.data_);
-        std::swap(size_, other.size_);
+    constexpr void Swap(Vector& other) noexcept {
+        assert(AllocTraits::propagate_on_container_swap::value || AllocTraits::is_always_equal::value
+               || data_.GetAllocator() == other.data_.GetAllocator());
+        SwapStorage(other);
+    }
+
+    [[nodiscard]] constexpr Allocator GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    [[nodiscard]] constexpr const StatsPolicy& GetStats() const noexcept {
+        return stats_;
     }
 
-    void Reserve(size_t new_capacity) {
-        if (new_capacity <= Capacity()) {
+    // location нужен только политике статистики с трассировкой роста, см. vector_trace.h
+    constexpr void Reserve(size_t new_capacity, std::source_location location = std::source_location::current()) {
+        if (new_capacity > Capacity()) {
+            Grow(new_capacity, "Reserve", location);
+        }
+    }
+
+    // Переносит элементы в новый буфер параллельно. Гарантии те же, что у Reserve(new_capacity)
+    void Reserve(size_t new_capacity, const ParallelExecution& policy) {
+        if (new_capacity <= Capacity() || TryGrowInPlace(new_capacity)) {
             return;
         }
-        RawMemory<T> new_data(new_capacity);
-        FillNewData(new_data, size_);
-        std::destroy_n(begin(), size_);
+        RawMemory<T, Allocator> new_data = AllocateStorage(new_capacity, data_.GetAllocator());
+        vector_detail::UninitializedRelocateN(begin(), size_, new_data.GetAddress(), policy);
+        NoteReallocation(new_data.Capacity());
         data_.Swap(new_data);
     }
 
-    void Resize(size_t new_size) {
-        if (new_size < size_) {
-            std::destroy_n(begin() + new_size, size_ - new_size);
+    // Уменьшает вместимость до размера одним перевыделением; у пустого вектора освобождает буфер
+    constexpr void ShrinkToFit() {
+        if (Capacity() == size_) {
+            return;
         }
-        else {
-            if (new_size > Capacity()) {
-                size_t new_capacity = std::max(Capacity() * 2, new_size);
-                Reserve(new_capacity);
+        if (size_ == 0) {
+            RawMemory<T, Allocator> empty(data_.GetAllocator());
+            data_.Swap(empty);
+        }
+        else if (!TryShrinkInPlace()) {
+            Reallocate(size_);
+        }
+    }
+
+    // Разрушает элементы, сохраняя вместимость
+    constexpr void Clear() noexcept {
+        std::destroy_n(begin(), size_);
+        size_ = 0;
+    }
+
+    // Разрушает элементы параллельно. Деструктор разрушает их в одном потоке, поэтому большой
+    // вектор перед уничтожением стоит очищать этой перегрузкой
+    void Clear(const ParallelExecution& policy) noexcept {
+        parallel_detail::DestroyN(begin(), size_, policy);
+        size_ = 0;
+    }
+
+    // Принимает во владение буфер с size уже созданными элементами. Буфер на capacity элементов
+    // должен быть выделен аллокатором, равным alloc, и выровнен под T: так данные, прочитанные
+    // из сети или файла прямо в буфер, становятся вектором без копирования
+    [[nodiscard]] static Vector Adopt(T* data, size_t size, size_t capacity, const Allocator& alloc = Allocator()) {
+        assert(size <= capacity);
+        assert(reinterpret_cast<std::uintptr_t>(data) % alignof(T) == 0);
+        return Vector(RawMemory<T, Allocator>(data, capacity, alloc), size);
+    }
+
+    // Отдаёт буфер вместе с элементами, обратная операция к Adopt. Вектор остаётся пустым
+    // и без памяти
+    [[nodiscard]] ReleasedBuffer<T> Release() noexcept {
+        ReleasedBuffer<T> released{nullptr, size_, data_.Capacity()};
+        released.data = data_.Release();
+        size_ = 0;
+        return released;
+    }
+
+    // Байтовое представление элементов для записи без промежуточного буфера, например writev
+    [[nodiscard]] std::span<const std::byte> AsBytes() const noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects have a byte representation");
+        return std::as_bytes(std::span<const T>(data_.GetAddress(), size_));
+    }
+
+    [[nodiscard]] std::span<std::byte> AsWritableBytes() noexcept {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable objects have a byte representation");
+        return std::as_writable_bytes(std::span<T>(data_.GetAddress(), size_));
+    }
+
+    // Разрушает элементы и забирает у вектора буфер: он освободится вместе с возвращённым
+    // объектом, если тот не будет использован. Вектор остаётся пустым и без памяти
+    RawMemory<T, Allocator> ReleaseStorage() noexcept {
+        Clear();
+        RawMemory<T, Allocator> storage(data_.GetAllocator());
+        data_.Swap(storage);
+        return storage;
+    }
+
+    constexpr void Resize(size_t new_size, std::source_location location = std::source_location::current()) {
+        ResizeWith(new_size, location, [](T* first, size_t count) {
+            vector_detail::UninitializedValueConstructN(first, count);
+        });
+    }
+
+    // Новые элементы инициализируются по умолчанию: для тривиальных типов их значения
+    // не определены, и память не заполняется нулями перед последующей перезаписью
+    constexpr void ResizeDefaultInit(size_t new_size,
+                                     std::source_location location = std::source_location::current()) {
+        ResizeWith(new_size, location, [](T* first, size_t count) {
+            vector_detail::UninitializedDefaultConstructN(first, count);
+        });
+    }
+
+    // Увеличивает размер до count и передаёт буфер в op(data, count), которая заполняет
+    // элементы и возвращает, сколько из них действительно записано. Вектор обрезается
+    // до этого числа; если op бросает исключение, восстанавливается прежний размер
+    template <typename Operation>
+    void ResizeAndOverwrite(size_t count, Operation op) {
+        const size_t old_size = size_;
+        ResizeDefaultInit(count);
+        size_t written = 0;
+        try {
+            written = std::move(op)(begin(), count);
+        }
+        catch (...) {
+            if (size_ > old_size) {
+                std::destroy_n(begin() + old_size, size_ - old_size);
+                size_ = old_size;
             }
-            std::uninitialized_value_construct_n(end(), new_size - size_);
+            throw;
         }
-        size_ = new_size;
+        assert(written <= count);
+        std::destroy_n(begin() + written, size_ - written);
+        size_ = written;
     }
 
     template <typename T1>
-    void PushBack(T1&& value) {
-        EmplaceBack(std::forward<T1>(value));
+    constexpr void PushBack(T1&& value, std::source_location location = std::source_location::current()) {
+        if (size_ != Capacity()) [[likely]] {
+            std::construct_at(end(), std::forward<T1>(value));
+            ++size_;
+            return;
+        }
+        GrowAndEmplaceBack("PushBack", location, std::forward<T1>(value));
     }
 
-    void PopBack() noexcept {
+    constexpr void PopBack() noexcept {
         assert(size_);
         std::destroy_at(end() - 1);
         --size_;
     }
 
+    // Добавление в конец проверяет только вместимость; рост вынесен в GrowAndEmplaceBack
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        return EmplaceBackAt(std::source_location::current(), std::forward<Args>(args)...);
+    }
+
+    // EmplaceBack с местом вызова для трассировки роста: у вариативного метода не может
+    // быть параметра по умолчанию после аргументов
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
-        return *(Emplace(end(), std::forward<Args>(args)...));
+    constexpr T& EmplaceBackAt(std::source_location location, Args&&... args) {
+        if (size_ != Capacity()) [[likely]] {
+            T* slot = std::construct_at(end(), std::forward<Args>(args)...);
+            ++size_;
+            return *slot;
+        }
+        return GrowAndEmplaceBack("PushBack", location, std::forward<Args>(args)...);
     }
 
-    [[nodiscard]] size_t Size() const noexcept {
+    // Добавление в конец без проверки вместимости, для циклов после Reserve
+    template <typename... Args>
+    constexpr T& UncheckedEmplaceBack(Args&&... args) {
+        assert(size_ < Capacity());
+        T* slot = std::construct_at(end(), std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    // Добавляет count элементов, инициализированных по умолчанию, и возвращает указатель
+    // на первый из них. Записывать в них можно сразу, а тривиальные типы не обнуляются,
+    // поэтому декодер может выделить место под пакет значений и заполнить его напрямую
+    constexpr T* GrowBy(size_t count, std::source_location location = std::source_location::current()) {
+        const size_t old_size = size_;
+        ResizeDefaultInit(size_ + count, location);
+        return begin() + old_size;
+    }
+
+    [[nodiscard]] constexpr size_t Size() const noexcept {
         return size_;
     }
 
-    [[nodiscard]] size_t Capacity() const noexcept {
+    [[nodiscard]] constexpr size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < size_);
         return data_[index];
     }
 
-    iterator begin() noexcept {
+    // Поиск и сравнение для float, double и побайтово сравнимых типов идут через SIMD-ядра
+    // или memchr/memcmp, для остальных — через обычные циклы
+
+    [[nodiscard]] const_iterator Find(const T& value) const {
+        return begin() + simd_detail::FindIndex(begin(), size_, value);
+    }
+
+    [[nodiscard]] iterator Find(const T& value) {
+        return begin() + simd_detail::FindIndex(begin(), size_, value);
+    }
+
+    [[nodiscard]] size_t Count(const T& value) const {
+        return simd_detail::CountEqual(begin(), size_, value);
+    }
+
+    [[nodiscard]] bool Contains(const T& value) const {
+        return simd_detail::FindIndex(begin(), size_, value) != size_;
+    }
+
+    void Fill(const T& value) {
+        simd_detail::Fill(begin(), size_, value);
+    }
+
+    // Обходы с программным упреждением для случаев, где не помогает аппаратный префетчер:
+    // векторы указателей на разбросанные объекты и выборки по индексам. distance — на сколько
+    // элементов вперёд подсказывается загрузка; подбирается под задержку памяти и стоимость fn
+
+    template <typename Fn>
+    void ForEachPrefetched(size_t distance, Fn fn) {
+        prefetch_detail::ForEachPrefetched(begin(), size_, distance, fn);
+    }
+
+    template <typename Fn>
+    void ForEachPrefetched(size_t distance, Fn fn) const {
+        prefetch_detail::ForEachPrefetched(begin(), size_, distance, fn);
+    }
+
+    [[nodiscard]] PrefetchedRange<T> Prefetched(size_t distance = prefetch_detail::kDefaultDistance) noexcept {
+        return {begin(), end(), distance};
+    }
+
+    [[nodiscard]] PrefetchedRange<const T> Prefetched(
+        size_t distance = prefetch_detail::kDefaultDistance) const noexcept {
+        return {begin(), end(), distance};
+    }
+
+    // Копирует элементы с заданными индексами по порядку индексов, заранее подгружая
+    // элементы на distance индексов вперёд. indices — диапазон с произвольным доступом,
+    // все индексы должны быть меньше Size()
+    template <typename IndexRange>
+    [[nodiscard]] Vector Gather(const IndexRange& indices, size_t distance = prefetch_detail::kDefaultDistance,
+                                std::source_location location = std::source_location::current()) const {
+        const auto first = std::begin(indices);
+        const auto count = static_cast<size_t>(std::distance(first, std::end(indices)));
+        Vector result(AllocTraits::select_on_container_copy_construction(data_.GetAllocator()));
+        result.Reserve(count, location);
+        size_t pos = 0;
+        for (; pos + distance < count; ++pos) {
+            // Подгружаемый индекс проверится, когда до него дойдёт чтение
+            prefetch_detail::Prefetch(begin() + first[pos + distance]);
+            assert(static_cast<size_t>(first[pos]) < size_);
+            result.UncheckedEmplaceBack(data_[first[pos]]);
+        }
+        for (; pos < count; ++pos) {
+            assert(static_cast<size_t>(first[pos]) < size_);
+            result.UncheckedEmplaceBack(data_[first[pos]]);
+        }
+        return result;
+    }
+
+    friend constexpr bool operator==(const Vector& lhs, const Vector& rhs)
+        requires std::equality_comparable<T>
+    {
+        if (std::is_constant_evaluated()) {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+        return lhs.size_ == rhs.size_ && simd_detail::Equal(lhs.begin(), rhs.begin(), lhs.size_);
+    }
+
+    friend constexpr auto operator<=>(const Vector& lhs, const Vector& rhs)
+        requires std::three_way_comparable<T>
+    {
+        if (std::is_constant_evaluated()) {
+            return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+        return simd_detail::Compare(lhs.begin(), lhs.size_, rhs.begin(), rhs.size_);
+    }
+
+    constexpr iterator begin() noexcept {
         return data_.GetAddress();
     }
 
-    iterator end() noexcept {
+    constexpr iterator end() noexcept {
         return data_.GetAddress() + size_;
     }
 
-    const_iterator begin() const noexcept {
+    constexpr const_iterator begin() const noexcept {
         return cbegin();
     }
 
-    const_iterator end() const noexcept {
+    constexpr const_iterator end() const noexcept {
         return cend();
     }
 
-    const_iterator cbegin() const noexcept {
+    constexpr const_iterator cbegin() const noexcept {
         return data_.GetAddress();
     }
 
-    const_iterator cend() const noexcept {
+    constexpr const_iterator cend() const noexcept {
         return data_.GetAddress() + size_;
     }
 
     template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args) {
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+        return EmplaceAt(std::source_location::current(), pos, std::forward<Args>(args)...);
+    }
+
+    // Emplace с местом вызова, как EmplaceBackAt
+    template <typename... Args>
+    constexpr iterator EmplaceAt(std::source_location location, const_iterator pos, Args&&... args) {
         size_t iterator_pos = pos - begin();
         if (size_ == Capacity()) {
-            InsertWithoutRelocation(iterator_pos, pos, std::forward<Args>(args)...);
+            InsertWithoutRelocation("Insert", location, iterator_pos, std::forward<Args>(args)...);
         }
         else {
             InsertWithRelocation(iterator_pos, pos, std::forward<Args>(args)...);
@@ -246,66 +1055,555 @@ public:
         return begin() + iterator_pos;
     }
 
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    constexpr iterator Erase(const_iterator pos) noexcept(IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
         assert(pos >= cbegin() && pos < cend());
         size_t iterator_pos = pos - cbegin();
-        std::move(begin() + iterator_pos + 1, end(), begin() + iterator_pos);
-        PopBack();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            std::destroy_at(begin() + iterator_pos);
+            vector_detail::RelocateBitwise(begin() + iterator_pos + 1, size_ - iterator_pos - 1, begin() + iterator_pos);
+            --size_;
+        }
+        else {
+            std::move(begin() + iterator_pos + 1, end(), begin() + iterator_pos);
+            PopBack();
+        }
         return begin() + iterator_pos;
     }
 
-    iterator Insert(const_iterator pos, const T& value) {
-        return Emplace(pos, value);
+    constexpr iterator Erase(const_iterator first, const_iterator last) noexcept(IsTriviallyRelocatableV<T>
+                                                                      || std::is_nothrow_move_assignable_v<T>) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t first_pos = first - cbegin();
+        const size_t count = last - first;
+        if (count != 0) {
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                std::destroy_n(begin() + first_pos, count);
+                vector_detail::RelocateBitwise(begin() + first_pos + count, size_ - first_pos - count,
+                                               begin() + first_pos);
+            }
+            else {
+                std::move(begin() + first_pos + count, end(), begin() + first_pos);
+                std::destroy_n(end() - count, count);
+            }
+            size_ -= count;
+        }
+        return begin() + first_pos;
+    }
+
+    // Удаляет все элементы, для которых pred возвращает true, за один проход.
+    // Возвращает число удалённых элементов
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            return RelocatingEraseIf(pred);
+        }
+        else {
+            iterator new_end = std::remove_if(begin(), end(), pred);
+            const size_t removed = end() - new_end;
+            std::destroy_n(new_end, removed);
+            size_ -= removed;
+            return removed;
+        }
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value,
+                              std::source_location location = std::source_location::current()) {
+        return EmplaceAt(location, pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T&& value,
+                              std::source_location location = std::source_location::current()) {
+        return EmplaceAt(location, pos, std::move(value));
+    }
+
+    // Вставляет диапазон, вычислив итоговый размер заранее: буфер растёт не больше одного раза.
+    // Диапазон не должен ссылаться на элементы самого вектора
+    template <typename InputIt, std::enable_if_t<vector_detail::IsInputIterator<InputIt>::value, int> = 0>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last,
+                    std::source_location location = std::source_location::current()) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t iterator_pos = pos - cbegin();
+        if constexpr (vector_detail::IsForwardIterator<InputIt>::value) {
+            return InsertRange(iterator_pos, first, static_cast<size_t>(std::distance(first, last)), "Insert",
+                               location);
+        }
+        else {
+            return InsertInputRange(iterator_pos, first, last, "Insert", location);
+        }
+    }
+
+    iterator Insert(const_iterator pos, size_t count, const T& value,
+                    std::source_location location = std::source_location::current()) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t iterator_pos = pos - cbegin();
+        if (std::less_equal<const T*>()(cbegin(), &value) && std::less<const T*>()(&value, cend())) {
+            // Значение лежит в самом векторе и может сдвинуться при вставке
+            const T value_copy(value);
+            return InsertRange(iterator_pos, vector_detail::RepeatIterator<T>(&value_copy, 0), count, "Insert",
+                               location);
+        }
+        return InsertRange(iterator_pos, vector_detail::RepeatIterator<T>(&value, 0), count, "Insert", location);
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> init,
+                    std::source_location location = std::source_location::current()) {
+        return Insert(pos, init.begin(), init.end(), location);
+    }
+
+    // Добавляет в конец элементы диапазона. У непрерывных источников (массивов, std::vector,
+    // Vector) элементы копируются через указатели, что позволяет копировать их одним memcpy
+    template <typename Range>
+    void Append(const Range& range, std::source_location location = std::source_location::current()) {
+        if constexpr (vector_detail::IsContiguousRange<Range>::value) {
+            InsertRange(size_, std::data(range), std::size(range), "Append", location);
+        }
+        else if constexpr (vector_detail::IsForwardIterator<decltype(std::begin(range))>::value) {
+            const size_t count = static_cast<size_t>(std::distance(std::begin(range), std::end(range)));
+            InsertRange(size_, std::begin(range), count, "Append", location);
+        }
+        else {
+            InsertInputRange(size_, std::begin(range), std::end(range), "Append", location);
+        }
     }
 
-    iterator Insert(const_iterator pos, T&& value) {
-        return Emplace(pos, std::move(value));
+    void Append(std::initializer_list<T> init, std::source_location location = std::source_location::current()) {
+        InsertRange(size_, init.begin(), init.size(), "Append", location);
+    }
+
+    template <typename InputIt, std::enable_if_t<vector_detail::IsInputIterator<InputIt>::value, int> = 0>
+    constexpr void Assign(InputIt first, InputIt last, std::source_location location = std::source_location::current()) {
+        if constexpr (vector_detail::IsForwardIterator<InputIt>::value) {
+            AssignN(first, static_cast<size_t>(std::distance(first, last)), location);
+        }
+        else {
+            size_t pos = 0;
+            for (; pos < size_ && first != last; ++pos, ++first) {
+                data_[pos] = *first;
+            }
+            if (pos < size_) {
+                std::destroy_n(begin() + pos, size_ - pos);
+                size_ = pos;
+            }
+            else {
+                InsertInputRange(size_, first, last, "Assign", location);
+            }
+        }
+    }
+
+    constexpr void Assign(size_t count, const T& value,
+                          std::source_location location = std::source_location::current()) {
+        AssignN(vector_detail::RepeatIterator<T>(&value, 0), count, location);
+    }
+
+    constexpr void Assign(std::initializer_list<T> init,
+                          std::source_location location = std::source_location::current()) {
+        AssignN(init.begin(), init.size(), location);
+    }
+
+protected:
+    // Принимает буфер, в котором уже созданы первые size элементов
+    constexpr Vector(RawMemory<T, Allocator>&& storage, size_t size) noexcept
+        : data_(std::move(storage))
+        , size_(size)
+    {
+        assert(size_ <= data_.Capacity());
+    }
+
+    // Обменивает буферы без проверки аллокаторов. Наследники вызывают его, когда знают,
+    // что каждый буфер может быть освобождён аллокатором другой стороны
+    constexpr void SwapStorage(Vector& other) noexcept {
+        data_.Swap(other.data_);
+        std::swap(size_, other.size_);
     }
 
 private:
-    RawMemory<T> data_;
+    // Объявлена раньше data_, чтобы учитывать выделения уже в списках инициализации
+    [[no_unique_address]] StatsPolicy stats_;
+    RawMemory<T, Allocator> data_;
     size_t size_ = 0;
 
-    void FillNewData(RawMemory<T>& new_data, size_t pos) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(begin(), pos, new_data.GetAddress());
+    constexpr RawMemory<T, Allocator> AllocateStorage(size_t capacity, const Allocator& alloc) {
+        RawMemory<T, Allocator> storage(capacity, alloc);
+        if (storage.Capacity() != 0) {
+            stats_.OnAllocate(storage.Capacity(), storage.Capacity() * sizeof(T));
+        }
+        return storage;
+    }
+
+    // Учитывает переезд size_ элементов в новый буфер тем способом, который выберет
+    // UninitializedRelocateN. Вызывается до обмена буферов
+    constexpr void NoteReallocation(size_t new_capacity) noexcept {
+        if (size_ == 0) {
+            return;
+        }
+        stats_.OnReallocate(Capacity(), new_capacity);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            stats_.OnRelocate(size_);
+        }
+        else if constexpr (vector_detail::kMoveOnRelocate<T>) {
+            stats_.OnMove(size_);
         }
         else {
-            std::uninitialized_copy_n(begin(), pos, new_data.GetAddress());
+            stats_.OnCopy(size_);
+        }
+    }
+
+    constexpr bool TryExpandStorage(size_t new_capacity) noexcept {
+        const size_t old_capacity = Capacity();
+        if (data_.TryExpandInPlace(new_capacity)) {
+            stats_.OnGrowInPlace(old_capacity, new_capacity);
+            return true;
+        }
+        return false;
+    }
+
+    constexpr bool TryReallocateStorage(size_t new_capacity) noexcept {
+        const size_t old_capacity = Capacity();
+        if (data_.TryReallocate(new_capacity)) {
+            stats_.OnGrowInPlace(old_capacity, new_capacity);
+            return true;
+        }
+        return false;
+    }
+
+    constexpr size_t CalculateGrowth(size_t min_capacity) const noexcept {
+        const size_t new_capacity = GrowthPolicy::NewCapacity(Capacity(), min_capacity, sizeof(T));
+        assert(new_capacity >= min_capacity);
+        return new_capacity;
+    }
+
+    // Рост без вставки: на месте, если аллокатор умеет, иначе переездом
+    constexpr void Grow(size_t new_capacity, const char* operation, const std::source_location& location) {
+        TraceGrowth(operation, location, [&] {
+            if (!TryGrowInPlace(new_capacity)) {
+                Reallocate(new_capacity);
+            }
+        });
+    }
+
+    // Выполняет grow и, если политика статистики трассирует рост, сообщает ей событие
+    // со старой и новой вместимостью, длительностью и местом вызова. Без трассировки
+    // таймер не читается. По умолчанию при смене буфера считаются перенесёнными все прежние
+    // элементы; grow, которая их не переносит (присваивание), возвращает их число сама
+    template <typename Operation>
+    constexpr void TraceGrowth(const char* operation, const std::source_location& location, Operation grow) {
+        if constexpr (vector_detail::HasGrowthTracing<StatsPolicy>::value) {
+            if (!std::is_constant_evaluated()) {
+                const size_t old_capacity = Capacity();
+                const T* old_data = data_.GetAddress();
+                const size_t old_size = size_;
+                const auto start = std::chrono::steady_clock::now();
+                size_t relocated = 0;
+                if constexpr (std::is_void_v<decltype(grow())>) {
+                    grow();
+                    // При росте на месте элементы не переезжают
+                    relocated = data_.GetAddress() != old_data ? old_size : 0;
+                }
+                else {
+                    relocated = grow();
+                }
+                const auto finish = std::chrono::steady_clock::now();
+                stats_.OnGrowth(GrowthEvent{operation, location, old_capacity, Capacity(), relocated, sizeof(T),
+                                            start.time_since_epoch(), finish - start});
+                return;
+            }
         }
+        grow();
+    }
+
+    constexpr void Reallocate(size_t new_capacity) {
+        RawMemory<T, Allocator> new_data = AllocateStorage(new_capacity, data_.GetAllocator());
+        vector_detail::UninitializedRelocateN(begin(), size_, new_data.GetAddress());
+        NoteReallocation(new_data.Capacity());
+        data_.Swap(new_data);
+    }
+
+    template <typename Constructor>
+    constexpr void ResizeWith(size_t new_size, const std::source_location& location, Constructor construct) {
+        if (new_size < size_) {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        }
+        else {
+            if (new_size > Capacity()) {
+                Grow(CalculateGrowth(new_size), "Resize", location);
+            }
+            construct(end(), new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Уменьшает буфер через reallocate аллокатора, если он его поддерживает
+    constexpr bool TryShrinkInPlace() noexcept {
+        if constexpr (RawMemory<T, Allocator>::kCanReallocate && IsTriviallyRelocatableV<T>) {
+            return data_.TryReallocate(size_);
+        }
+        return false;
+    }
+
+    // Пытается нарастить буфер без выделения нового блока и поэлементного переноса
+    constexpr bool TryGrowInPlace(size_t new_capacity) noexcept {
+        if (TryExpandStorage(new_capacity)) {
+            return true;
+        }
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            return TryReallocateStorage(new_capacity);
+        }
+        return false;
+    }
+
+    // Присваивает вектору n элементов из src, переиспользуя текущий буфер, если его хватает.
+    // Новый буфер выбирается политикой роста, поэтому повторные присваивания понемногу
+    // растущих векторов перевыделяют память амортизированно, а не каждый раз. Ветка
+    // с новым буфером даёт строгую гарантию, ветка с переиспользованием — строгую для
+    // тривиально копируемых T и базовую для остальных. Сначала буфер пробует вырасти на месте:
+    // аллокатор с единственным буфером, как у MappedVector, второго не выделит
+    template <typename InputIt>
+    constexpr void AssignN(InputIt src, size_t n, const std::source_location& location) {
+        bool assigned = false;
+        if (n > Capacity()) {
+            const size_t new_capacity = CalculateGrowth(n);
+            TraceGrowth("Assign", location, [&] {
+                const T* old_data = data_.GetAddress();
+                if (TryGrowInPlace(new_capacity)) {
+                    return data_.GetAddress() != old_data ? size_ : size_t(0);
+                }
+                RawMemory<T, Allocator> new_data = AllocateStorage(new_capacity, data_.GetAllocator());
+                vector_detail::UninitializedCopyN(src, n, new_data.GetAddress());
+                std::destroy_n(begin(), size_);
+                data_.Swap(new_data);
+                assigned = true;
+                return size_t(0);
+            });
+        }
+        if (!assigned) {
+            const size_t common = std::min(size_, n);
+            src = vector_detail::CopyN(src, common, begin());
+            if (size_ > n) {
+                std::destroy_n(begin() + n, size_ - n);
+            }
+            else {
+                vector_detail::UninitializedCopyN(src, n - common, begin() + common);
+            }
+        }
+        size_ = n;
     }
 
     template <typename... Args>
-    void InsertWithRelocation(size_t iterator_pos, const_iterator pos, Args&&... args) {
-        try {
-            if (pos != end()) {
-                T temporary_obj(std::forward<Args>(args)...);
-                std::uninitialized_move_n(end() - 1, 1, end());
-                std::move_backward(data_ + iterator_pos, end() - 1, end());
-                data_[iterator_pos] = std::move(temporary_obj);
+    constexpr void InsertWithRelocation(size_t iterator_pos, const_iterator pos, Args&&... args) {
+        if (pos != end()) {
+            T temporary_obj(std::forward<Args>(args)...);
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                vector_detail::RelocateBitwise(begin() + iterator_pos, size_ - iterator_pos, begin() + iterator_pos + 1);
+                try {
+                    std::construct_at(begin() + iterator_pos, std::move(temporary_obj));
+                }
+                catch (...) {
+                    vector_detail::RelocateBitwise(begin() + iterator_pos + 1, size_ - iterator_pos, begin() + iterator_pos);
+                    throw;
+                }
             }
             else {
-                new (end()) T(std::forward<Args>(args)...);
+                std::construct_at(end(), std::move(*(end() - 1)));
+                try {
+                    std::move_backward(data_ + iterator_pos, end() - 1, end());
+                    data_[iterator_pos] = std::move(temporary_obj);
+                }
+                catch (...) {
+                    std::destroy_at(end());
+                    throw;
+                }
             }
         }
-        catch (...) {
-            operator delete (end());
-            throw;
+        else {
+            std::construct_at(end(), std::forward<Args>(args)...);
         }
     }
 
     template <typename... Args>
-    void InsertWithoutRelocation(size_t iterator_pos, const_iterator pos, Args&&... args) {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-        new (new_data.GetAddress() + iterator_pos) T(std::forward<Args>(args)...);
-        FillNewData(new_data, iterator_pos);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(begin() + iterator_pos, size_ - iterator_pos, new_data.GetAddress() + iterator_pos + 1);
+    ADVANCED_VECTOR_COLD constexpr T& GrowAndEmplaceBack(const char* operation, const std::source_location& location,
+                                                         Args&&... args) {
+        InsertWithoutRelocation(operation, location, size_, std::forward<Args>(args)...);
+        ++size_;
+        return data_[size_ - 1];
+    }
+
+    template <typename... Args>
+    constexpr void InsertWithoutRelocation(const char* operation, const std::source_location& location,
+                                           size_t iterator_pos, Args&&... args) {
+        const size_t new_capacity = CalculateGrowth(size_ + 1);
+        TraceGrowth(operation, location, [&] {
+            GrowAndInsert(new_capacity, iterator_pos, std::forward<Args>(args)...);
+        });
+    }
+
+    template <typename... Args>
+    constexpr void GrowAndInsert(size_t new_capacity, size_t iterator_pos, Args&&... args) {
+        if (TryExpandStorage(new_capacity)) {
+            InsertWithRelocation(iterator_pos, begin() + iterator_pos, std::forward<Args>(args)...);
+        }
+        else if constexpr (IsTriviallyRelocatableV<T> && RawMemory<T, Allocator>::kCanReallocate) {
+            // Аргументы могут ссылаться на элементы вектора, которые переедут вместе с буфером
+            T temporary_obj(std::forward<Args>(args)...);
+            if (TryReallocateStorage(new_capacity)) {
+                InsertWithRelocation(iterator_pos, begin() + iterator_pos, std::move(temporary_obj));
+            }
+            else {
+                RelocateAndInsert(new_capacity, iterator_pos, std::move(temporary_obj));
+            }
         }
         else {
-            std::uninitialized_copy_n(begin() + iterator_pos, size_ - iterator_pos, new_data.GetAddress() + iterator_pos + 1);
+            RelocateAndInsert(new_capacity, iterator_pos, std::forward<Args>(args)...);
         }
-        std::destroy_n(begin(), size_);
+    }
+
+    template <typename... Args>
+    constexpr void RelocateAndInsert(size_t new_capacity, size_t iterator_pos, Args&&... args) {
+        ReallocateWithGap(new_capacity, iterator_pos, 1, [&](T* gap) {
+            std::construct_at(gap, std::forward<Args>(args)...);
+        });
+    }
+
+    // Переезжает в новый буфер, оставляя между первыми pos элементами и остальными
+    // промежуток из count элементов, который заполняет construct(gap). construct при
+    // исключении сам разрушает созданное; вектор при этом остаётся прежним
+    template <typename Constructor>
+    constexpr void ReallocateWithGap(size_t new_capacity, size_t pos, size_t count, Constructor&& construct) {
+        RawMemory<T, Allocator> new_data = AllocateStorage(new_capacity, data_.GetAllocator());
+        T* gap = new_data.GetAddress() + pos;
+        construct(gap);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            vector_detail::RelocateBitwise(begin(), pos, new_data.GetAddress());
+            vector_detail::RelocateBitwise(begin() + pos, size_ - pos, gap + count);
+        }
+        else {
+            try {
+                vector_detail::UninitializedMoveOrCopyN(begin(), pos, new_data.GetAddress());
+            }
+            catch (...) {
+                std::destroy_n(gap, count);
+                throw;
+            }
+            try {
+                vector_detail::UninitializedMoveOrCopyN(begin() + pos, size_ - pos, gap + count);
+            }
+            catch (...) {
+                std::destroy_n(new_data.GetAddress(), pos + count);
+                throw;
+            }
+            std::destroy_n(begin(), size_);
+        }
+        NoteReallocation(new_data.Capacity());
         data_.Swap(new_data);
     }
+
+    template <typename ForwardIt>
+    iterator InsertRange(size_t pos, ForwardIt first, size_t count, const char* operation,
+                         const std::source_location& location) {
+        if (count == 0) {
+            return begin() + pos;
+        }
+        if (size_ + count > Capacity()) {
+            const size_t new_capacity = CalculateGrowth(size_ + count);
+            bool inserted = false;
+            TraceGrowth(operation, location, [&] {
+                if (!TryGrowInPlace(new_capacity)) {
+                    ReallocateWithGap(new_capacity, pos, count, [&](T* gap) {
+                        vector_detail::UninitializedCopyN(first, count, gap);
+                    });
+                    inserted = true;
+                }
+            });
+            if (inserted) {
+                size_ += count;
+                return begin() + pos;
+            }
+        }
+        T* position = begin() + pos;
+        const size_t elems_after = size_ - pos;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            vector_detail::RelocateBitwise(position, elems_after, position + count);
+            try {
+                vector_detail::UninitializedCopyN(first, count, position);
+            }
+            catch (...) {
+                vector_detail::RelocateBitwise(position + count, elems_after, position);
+                throw;
+            }
+            size_ += count;
+        }
+        else {
+            T* old_end = end();
+            if (elems_after > count) {
+                std::uninitialized_move(old_end - count, old_end, old_end);
+                size_ += count;
+                std::move_backward(position, old_end - count, old_end);
+                std::copy_n(first, count, position);
+            }
+            else {
+                ForwardIt mid = std::next(first, elems_after);
+                vector_detail::UninitializedCopyN(mid, count - elems_after, old_end);
+                size_ += count - elems_after;
+                std::uninitialized_move(position, old_end, old_end + (count - elems_after));
+                size_ += elems_after;
+                std::copy(first, mid, position);
+            }
+        }
+        return begin() + pos;
+    }
+
+    // Уплотняет вектор, перенося сохраняемые элементы целыми сериями через memmove.
+    // Если pred бросит исключение, непроверенный хвост сдвигается к уже уплотнённой части
+    template <typename Predicate>
+    size_t RelocatingEraseIf(Predicate& pred) {
+        T* data = begin();
+        // [0, write) уже уплотнено, [run_start, read) сохраняется, но ещё не перенесено
+        size_t write = 0;
+        size_t run_start = 0;
+        try {
+            for (size_t read = 0; read < size_; ++read) {
+                if (pred(std::as_const(data[read]))) {
+                    vector_detail::RelocateBitwise(data + run_start, read - run_start, data + write);
+                    write += read - run_start;
+                    std::destroy_at(data + read);
+                    run_start = read + 1;
+                }
+            }
+        }
+        catch (...) {
+            vector_detail::RelocateBitwise(data + run_start, size_ - run_start, data + write);
+            size_ = write + (size_ - run_start);
+            throw;
+        }
+        vector_detail::RelocateBitwise(data + run_start, size_ - run_start, data + write);
+        write += size_ - run_start;
+        const size_t removed = size_ - write;
+        size_ = write;
+        return removed;
+    }
+
+    // Однопроходный диапазон: число элементов заранее неизвестно, поэтому они добавляются
+    // в конец и затем ставятся на место поворотом. При исключении добавленное удаляется
+    template <typename InputIt>
+    constexpr iterator InsertInputRange(size_t pos, InputIt first, InputIt last, const char* operation,
+                                        const std::source_location& location) {
+        const size_t old_size = size_;
+        try {
+            for (; first != last; ++first) {
+                if (size_ == Capacity()) [[unlikely]] {
+                    GrowAndEmplaceBack(operation, location, *first);
+                }
+                else {
+                    std::construct_at(end(), *first);
+                    ++size_;
+                }
+            }
+        }
+        catch (...) {
+            std::destroy_n(begin() + old_size, size_ - old_size);
+            size_ = old_size;
+            throw;
+        }
+        std::rotate(begin() + pos, begin() + old_size, end());
+        return begin() + pos;
+    }
 };
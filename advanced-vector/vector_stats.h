@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <source_location>
+
+// Счётчики работы вектора с памятью. Перевыделения учитывают только смену буфера
+// с живыми элементами; elements_copied растёт, когда при переезде приходится копировать
+// элементы из-за конструктора перемещения, не помеченного noexcept
+struct VectorStats {
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    size_t reallocations = 0;
+    size_t in_place_growths = 0;
+    size_t elements_moved = 0;
+    size_t elements_copied = 0;
+    size_t elements_relocated = 0;
+    size_t peak_capacity = 0;
+
+    void OnAllocate(size_t capacity, size_t bytes) noexcept {
+        ++allocations;
+        bytes_allocated += bytes;
+        peak_capacity = std::max(peak_capacity, capacity);
+    }
+
+    void OnReallocate(size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+        ++reallocations;
+    }
+
+    void OnGrowInPlace(size_t /*old_capacity*/, size_t new_capacity) noexcept {
+        ++in_place_growths;
+        peak_capacity = std::max(peak_capacity, new_capacity);
+    }
+
+    void OnMove(size_t count) noexcept {
+        elements_moved += count;
+    }
+
+    void OnCopy(size_t count) noexcept {
+        elements_copied += count;
+    }
+
+    void OnRelocate(size_t count) noexcept {
+        elements_relocated += count;
+    }
+};
+
+// Событие роста вектора: operation — "Reserve", "Resize", "PushBack", "Insert", "Append",
+// "Assign" или "Construct", location — место вызова публичного метода. Вариативные EmplaceBack
+// и Emplace записываются как "PushBack" и "Insert" и получают место вызова только через
+// EmplaceBackAt и EmplaceAt: без них location указывает внутрь vector.h. Операторы
+// присваивания не могут принять место вызова, и у их событий location пустой
+struct GrowthEvent {
+    const char* operation;
+    std::source_location location;
+    size_t old_capacity;
+    size_t new_capacity;
+    size_t elements_relocated;
+    size_t element_size;
+    std::chrono::steady_clock::duration start;
+    std::chrono::steady_clock::duration elapsed;
+};
+
+// Политика статистики задаётся параметром шаблона Vector. Политика по умолчанию не хранит
+// ничего, а её пустые методы исчезают после встраивания. Политике с методом
+// OnGrowth(const GrowthEvent&) вектор дополнительно сообщает о каждом росте буфера
+struct NoVectorStats {
+    static constexpr bool kEnabled = false;
+
+    constexpr void OnAllocate(size_t, size_t) noexcept {
+    }
+
+    constexpr void OnReallocate(size_t, size_t) noexcept {
+    }
+
+    constexpr void OnGrowInPlace(size_t, size_t) noexcept {
+    }
+
+    constexpr void OnMove(size_t) noexcept {
+    }
+
+    constexpr void OnCopy(size_t) noexcept {
+    }
+
+    constexpr void OnRelocate(size_t) noexcept {
+    }
+};
+
+// Своя статистика у каждого вектора. Копии и перемещённые векторы начинают с нуля
+struct PerInstanceVectorStats : VectorStats {
+    static constexpr bool kEnabled = true;
+
+    PerInstanceVectorStats() = default;
+
+    PerInstanceVectorStats(const PerInstanceVectorStats&) noexcept {
+    }
+
+    PerInstanceVectorStats& operator=(const PerInstanceVectorStats&) noexcept {
+        return *this;
+    }
+
+    [[nodiscard]] const VectorStats& Get() const noexcept {
+        return *this;
+    }
+
+    void Reset() noexcept {
+        static_cast<VectorStats&>(*this) = VectorStats();
+    }
+};
+
+// Общая статистика всех векторов с одним и тем же Tag, например с одним типом элемента.
+// Счётчики не атомарны: векторы с общей статистикой не следует менять из разных потоков
+template <typename Tag>
+struct PerTypeVectorStats {
+    static constexpr bool kEnabled = true;
+
+    static VectorStats& Get() noexcept {
+        static VectorStats stats;
+        return stats;
+    }
+
+    static void Reset() noexcept {
+        Get() = VectorStats();
+    }
+
+    void OnAllocate(size_t capacity, size_t bytes) noexcept {
+        Get().OnAllocate(capacity, bytes);
+    }
+
+    void OnReallocate(size_t old_capacity, size_t new_capacity) noexcept {
+        Get().OnReallocate(old_capacity, new_capacity);
+    }
+
+    void OnGrowInPlace(size_t old_capacity, size_t new_capacity) noexcept {
+        Get().OnGrowInPlace(old_capacity, new_capacity);
+    }
+
+    void OnMove(size_t count) noexcept {
+        Get().OnMove(count);
+    }
+
+    void OnCopy(size_t count) noexcept {
+        Get().OnCopy(count);
+    }
+
+    void OnRelocate(size_t count) noexcept {
+        Get().OnRelocate(count);
+    }
+};
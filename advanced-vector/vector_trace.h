@@ -0,0 +1,225 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <utility>
+
+// Кольцевой буфер событий роста векторов одного потока. Запись идёт только из своего потока
+// и не берёт блокировок; при переполнении затираются самые старые события. Буфер выделяется
+// при первой записи, а если памяти нет, события молча теряются.
+//
+// Буферы всех потоков учтены в общем реестре, и WriteChromeTraceAllThreads собирает их
+// в один дамп. Чтение чужих буферов не синхронизировано с записью, поэтому на время
+// WriteChromeTraceAllThreads и ClearAllThreads остальные потоки не должны менять векторы
+// с трассировкой: например, они уже завершены через join или ждут на барьере. Буфер
+// завершившегося потока с событиями остаётся в реестре до ClearAllThreads
+class GrowthTrace {
+public:
+    static constexpr size_t kCapacity = 4096;
+
+    GrowthTrace(const GrowthTrace&) = delete;
+    GrowthTrace& operator=(const GrowthTrace&) = delete;
+
+    static GrowthTrace& ThisThread() noexcept;
+
+    void Record(const GrowthEvent& event) noexcept {
+        if (events_ == nullptr) {
+            events_.reset(new (std::nothrow) GrowthEvent[kCapacity]);
+            if (events_ == nullptr) {
+                return;
+            }
+        }
+        events_[written_ % kCapacity] = event;
+        ++written_;
+    }
+
+    // Сколько событий сейчас хранится
+    [[nodiscard]] size_t Size() const noexcept {
+        return written_ < kCapacity ? written_ : kCapacity;
+    }
+
+    // Сколько событий затёрто из-за переполнения
+    [[nodiscard]] size_t Dropped() const noexcept {
+        return written_ - Size();
+    }
+
+    void Clear() noexcept {
+        written_ = 0;
+    }
+
+    // События от старых к новым
+    [[nodiscard]] Vector<GrowthEvent> Events() const {
+        Vector<GrowthEvent> events;
+        events.Reserve(Size());
+        for (size_t index = written_ - Size(); index < written_; ++index) {
+            events.UncheckedEmplaceBack(events_[index % kCapacity]);
+        }
+        return events;
+    }
+
+    // JSON в формате Chrome Trace Event, который открывают chrome://tracing и Perfetto:
+    // каждое событие — отрезок с длительностью роста, а вместимости, число перенесённых
+    // элементов и место вызова лежат в args
+    void WriteChromeTrace(std::ostream& out) const {
+        bool first = true;
+        out << "{\"traceEvents\":[";
+        WriteEvents(out, first);
+        out << "\n]}\n";
+    }
+
+    // Один дамп с событиями всех потоков, включая завершившиеся
+    static void WriteChromeTraceAllThreads(std::ostream& out) {
+        Registry& registry = GetRegistry();
+        const std::lock_guard lock(registry.mutex);
+        bool first = true;
+        out << "{\"traceEvents\":[";
+        for (const GrowthTrace* trace = registry.head; trace != nullptr; trace = trace->next_) {
+            trace->WriteEvents(out, first);
+        }
+        out << "\n]}\n";
+    }
+
+    // Очищает буферы работающих потоков и забывает буферы завершившихся
+    static void ClearAllThreads() noexcept {
+        Registry& registry = GetRegistry();
+        const std::lock_guard lock(registry.mutex);
+        GrowthTrace** link = &registry.head;
+        while (*link != nullptr) {
+            GrowthTrace* trace = *link;
+            if (trace->retired_) {
+                *link = trace->next_;
+                delete trace;
+            }
+            else {
+                trace->Clear();
+                link = &trace->next_;
+            }
+        }
+    }
+
+private:
+    // Реестр буферов: односвязный список под мьютексом. Мьютекс берётся только при старте
+    // и завершении потока и при сборе дампа, но не при записи событий
+    struct Registry {
+        std::mutex mutex;
+        GrowthTrace* head = nullptr;
+
+        ~Registry() {
+            while (head != nullptr) {
+                delete std::exchange(head, head->next_);
+            }
+        }
+    };
+
+    struct ThreadSlot;
+
+    std::unique_ptr<GrowthEvent[]> events_;
+    size_t written_ = 0;
+    uint32_t thread_id_;
+    bool retired_ = false;
+    GrowthTrace* next_ = nullptr;
+
+    static inline std::atomic<uint32_t> next_thread_id_{1};
+
+    GrowthTrace() noexcept
+        : thread_id_(next_thread_id_.fetch_add(1, std::memory_order_relaxed)) {
+    }
+
+    // Забирает события у буфера завершающегося потока
+    explicit GrowthTrace(GrowthTrace& exiting) noexcept
+        : events_(std::move(exiting.events_))
+        , written_(std::exchange(exiting.written_, 0))
+        , thread_id_(exiting.thread_id_)
+        , retired_(true) {
+    }
+
+    // Статические объекты разрушаются после thread_local-объектов главного потока,
+    // поэтому буфер главного потока успевает отписаться от реестра
+    static Registry& GetRegistry() noexcept {
+        static Registry registry;
+        return registry;
+    }
+
+    void WriteEvents(std::ostream& out, bool& first) const {
+        for (size_t position = written_ - Size(); position < written_; ++position) {
+            const GrowthEvent& event = events_[position % kCapacity];
+            out << (first ? "" : ",") << "\n{\"name\":\"" << event.operation
+                << "\",\"cat\":\"vector\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread_id_ << ",\"ts\":";
+            WriteMicroseconds(out, event.start);
+            out << ",\"dur\":";
+            WriteMicroseconds(out, event.elapsed);
+            out << ",\"args\":{\"old_capacity\":" << event.old_capacity << ",\"new_capacity\":" << event.new_capacity
+                << ",\"elements_relocated\":" << event.elements_relocated
+                << ",\"bytes\":" << event.new_capacity * event.element_size << ",\"file\":\"";
+            WriteEscaped(out, event.location.file_name());
+            out << "\",\"line\":" << event.location.line() << ",\"function\":\"";
+            WriteEscaped(out, event.location.function_name());
+            out << "\"}}";
+            first = false;
+        }
+    }
+
+    static void WriteMicroseconds(std::ostream& out, std::chrono::steady_clock::duration duration) {
+        const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        const auto fraction = nanoseconds % 1000;
+        out << nanoseconds / 1000 << '.' << fraction / 100 << fraction / 10 % 10 << fraction % 10;
+    }
+
+    static void WriteEscaped(std::ostream& out, const char* text) {
+        for (; *text != '\0'; ++text) {
+            if (*text == '"' || *text == '\\') {
+                out << '\\';
+            }
+            out << *text;
+        }
+    }
+};
+
+// Буфер потока. При завершении потока события переезжают в буфер, которым владеет реестр
+struct GrowthTrace::ThreadSlot {
+    GrowthTrace trace;
+
+    ThreadSlot() noexcept {
+        Registry& registry = GetRegistry();
+        const std::lock_guard lock(registry.mutex);
+        trace.next_ = std::exchange(registry.head, &trace);
+    }
+
+    ~ThreadSlot() {
+        Registry& registry = GetRegistry();
+        const std::lock_guard lock(registry.mutex);
+        GrowthTrace** link = &registry.head;
+        while (*link != &trace) {
+            link = &(*link)->next_;
+        }
+        *link = trace.next_;
+        if (trace.Size() != 0) {
+            if (GrowthTrace* retired = new (std::nothrow) GrowthTrace(trace)) {
+                retired->next_ = std::exchange(registry.head, retired);
+            }
+        }
+    }
+};
+
+inline GrowthTrace& GrowthTrace::ThisThread() noexcept {
+    thread_local ThreadSlot slot;
+    return slot.trace;
+}
+
+// Политика статистики, записывающая каждый рост буфера в GrowthTrace текущего потока.
+// Счётчики ведёт Base, поэтому трассировку можно совместить с PerInstanceVectorStats
+// или PerTypeVectorStats
+template <typename Base = NoVectorStats>
+struct TracingVectorStats : Base {
+    void OnGrowth(const GrowthEvent& event) noexcept {
+        GrowthTrace::ThisThread().Record(event);
+    }
+};